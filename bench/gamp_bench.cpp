@@ -0,0 +1,627 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gamp/gamp.hpp>
+
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <GLES2/gl2.h>
+
+/**
+ * gamp_bench runs registered scenes for a fixed frame count or duration,
+ * collecting CPU, GPU and frame time statistics, startup time and peak RSS,
+ * written as JSON and optionally compared against a baseline JSON result.
+ *
+ * Exit code 0 on success, 1 on error and 2 if regressions against the baseline were detected.
+ */
+
+using namespace jau::math;
+using namespace jau::math::util;
+
+//
+// scenes
+//
+
+struct scene_t {
+    const char* name;
+    bool (*init)();
+    void (*render)(uint64_t frame);
+    void (*dispose)();
+};
+
+static GLuint compile_program(const GLchar* vertexSource, const GLchar* fragmentSource) {
+    GLuint shaders[2] = { glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER) };
+    const GLchar* sources[2] = { vertexSource, fragmentSource };
+    GLuint program = glCreateProgram();
+    for(int i=0; i<2; ++i) {
+        glShaderSource(shaders[i], 1, &sources[i], nullptr);
+        glCompileShader(shaders[i]);
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &ok);
+        if( GL_FALSE == ok ) {
+            char log[512];
+            glGetShaderInfoLog(shaders[i], sizeof(log), nullptr, log);
+            printf("Bench: Shader compile error: %s\n", log);
+        }
+        glAttachShader(program, shaders[i]);
+    }
+    glLinkProgram(program);
+    glDeleteShader(shaders[0]);
+    glDeleteShader(shaders[1]);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if( GL_FALSE == ok ) {
+        printf("Bench: Program link error\n");
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static GLuint scene_program = 0;
+static GLuint scene_vbo = 0;
+static GLint scene_u0 = -1;
+
+static void dispose_program_vbo() {
+    glDeleteBuffers(1, &scene_vbo);
+    glDeleteProgram(scene_program);
+    scene_vbo = 0;
+    scene_program = 0;
+}
+
+// Scene 'clear': Color and depth buffer clear only, i.e. swap and pacing overhead
+
+static bool clear_init() { return true; }
+static void clear_render(uint64_t frame) {
+    const float c = static_cast<float>(frame % 256) / 255.0f;
+    glClearColor(c, 0.0f, 1.0f - c, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+static void clear_dispose() { }
+
+// Scene 'redsquare': Rotating square of examples/redsquare01
+
+static const GLchar* redsquare_vs =
+    "#version 100\n"
+    "precision highp float;\n"
+    "uniform mat4 mgl_PMVMatrix[2];\n"
+    "attribute vec4 mgl_Vertex;\n"
+    "varying vec4 frontColor;\n"
+    "void main(void) {\n"
+    "  frontColor = vec4(mgl_Vertex.xy * 0.25 + 0.5, 0.0, 1.0);\n"
+    "  gl_Position = mgl_PMVMatrix[0] * mgl_PMVMatrix[1] * mgl_Vertex;\n"
+    "}\n";
+static const GLchar* color_fs =
+    "#version 100\n"
+    "precision mediump float;\n"
+    "varying vec4 frontColor;\n"
+    "void main (void) { gl_FragColor = frontColor; }\n";
+
+static PMVMat4f redsquare_pmv;
+
+static bool redsquare_init() {
+    scene_program = compile_program(redsquare_vs, color_fs);
+    if( 0 == scene_program ) {
+        return false;
+    }
+    glUseProgram(scene_program);
+    scene_u0 = glGetUniformLocation(scene_program, "mgl_PMVMatrix");
+    const GLint a_vertices = glGetAttribLocation(scene_program, "mgl_Vertex");
+    const GLfloat vertices[] = { -2, 2, 0,  2, 2, 0,  -2, -2, 0,  2, -2, 0 };
+    glGenBuffers(1, &scene_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, scene_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(a_vertices);
+    glVertexAttribPointer(a_vertices, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    const float aspect = (float)gamp::viewport.width() / (float)gamp::viewport.height();
+    redsquare_pmv.getP().loadIdentity();
+    redsquare_pmv.perspectiveP(jau::adeg_to_rad(45.0f), aspect, 1.0f, 100.0f);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    return true;
+}
+static void redsquare_render(uint64_t frame) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    redsquare_pmv.getMv().loadIdentity();
+    redsquare_pmv.translateMv(0, 0, -10);
+    const float ang = jau::adeg_to_rad(static_cast<float>(frame % 360));
+    redsquare_pmv.rotateMv(ang, 0, 0, 1);
+    redsquare_pmv.rotateMv(ang, 0, 1, 0);
+    const PMVMat4f::SyncMats4& spmv = redsquare_pmv.getSyncPMv();
+    glUniformMatrix4fv(scene_u0, (GLsizei)spmv.matrixCount(), false, spmv.floats());
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+static void redsquare_dispose() {
+    glDisable(GL_DEPTH_TEST);
+    dispose_program_vbo();
+}
+
+// Scene 'fill': Blended fullscreen quads, i.e. fill-rate bound
+
+static constexpr int fill_layers = 16;
+static const GLchar* fill_vs =
+    "#version 100\n"
+    "precision highp float;\n"
+    "attribute vec2 mgl_Vertex;\n"
+    "uniform vec4 mgl_Color;\n"
+    "varying vec4 frontColor;\n"
+    "void main(void) {\n"
+    "  frontColor = mgl_Color;\n"
+    "  gl_Position = vec4(mgl_Vertex, 0.0, 1.0);\n"
+    "}\n";
+
+static bool fill_init() {
+    scene_program = compile_program(fill_vs, color_fs);
+    if( 0 == scene_program ) {
+        return false;
+    }
+    glUseProgram(scene_program);
+    scene_u0 = glGetUniformLocation(scene_program, "mgl_Color");
+    const GLint a_vertices = glGetAttribLocation(scene_program, "mgl_Vertex");
+    const GLfloat vertices[] = { -1, 1,  1, 1,  -1, -1,  1, -1 };
+    glGenBuffers(1, &scene_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, scene_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(a_vertices);
+    glVertexAttribPointer(a_vertices, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    return true;
+}
+static void fill_render(uint64_t frame) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    for(int i=0; i<fill_layers; ++i) {
+        const float c = static_cast<float>((frame + static_cast<uint64_t>(i) * 16) % 256) / 255.0f;
+        glUniform4f(scene_u0, c, 1.0f - c, 0.5f, 0.1f);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+}
+static void fill_dispose() {
+    glDisable(GL_BLEND);
+    dispose_program_vbo();
+}
+
+static const std::vector<scene_t> all_scenes = {
+    { "clear", clear_init, clear_render, clear_dispose },
+    { "redsquare", redsquare_init, redsquare_render, redsquare_dispose },
+    { "fill", fill_init, fill_render, fill_dispose },
+};
+
+//
+// results
+//
+
+struct scene_result_t {
+    std::string name;
+    uint64_t frames = 0;
+    double duration_ms = 0;
+    float fps = 0;
+    gamp::duration_percentiles_t frame;
+    gamp::duration_percentiles_t cpu;
+    gamp::duration_percentiles_t gpu;
+    bool has_gpu = false;
+};
+
+struct bench_result_t {
+    double startup_ms = 0;
+    int64_t peak_rss_kb = 0;
+    std::vector<scene_result_t> scenes;
+};
+
+static void write_percentiles(FILE* out, const char* name, const gamp::duration_percentiles_t& p) {
+    fprintf(out, "\"%s\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"over_budget\": %" PRIu64 " }",
+            name, p.p50 * 1000.0, p.p95 * 1000.0, p.p99 * 1000.0, p.max * 1000.0, p.over_budget);
+}
+
+static bool write_json(const std::string& path, const bench_result_t& r, const std::vector<std::string>& regressions) {
+    FILE* out = fopen(path.c_str(), "w");
+    if( nullptr == out ) {
+        printf("Bench: Error opening %s\n", path.c_str());
+        return false;
+    }
+    const char* renderer = reinterpret_cast<const char*>( glGetString(GL_RENDERER) );
+    fprintf(out, "{\n");
+    fprintf(out, "  \"gamp_version\": \"%s\",\n", gamp::VERSION.toString().c_str());
+    fprintf(out, "  \"gl_version\": \"%s\",\n", gamp::gl_version.toString().c_str());
+    fprintf(out, "  \"gl_renderer\": \"%s\",\n", nullptr != renderer ? renderer : "");
+    fprintf(out, "  \"headless\": %s,\n", gamp::is_headless() ? "true" : "false");
+    fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n", gamp::viewport.width(), gamp::viewport.height());
+    fprintf(out, "  \"startup_ms\": %.3f,\n", r.startup_ms);
+    fprintf(out, "  \"peak_rss_kb\": %" PRIi64 ",\n", r.peak_rss_kb);
+    fprintf(out, "  \"scenes\": [\n");
+    for(size_t i=0; i<r.scenes.size(); ++i) {
+        const scene_result_t& s = r.scenes[i];
+        fprintf(out, "    { \"name\": \"%s\", \"frames\": %" PRIu64 ", \"duration_ms\": %.3f, \"fps\": %.3f,\n      ",
+                s.name.c_str(), s.frames, s.duration_ms, s.fps);
+        write_percentiles(out, "frame_ms", s.frame);
+        fprintf(out, ",\n      ");
+        write_percentiles(out, "cpu_ms", s.cpu);
+        if( s.has_gpu ) {
+            fprintf(out, ",\n      ");
+            write_percentiles(out, "gpu_ms", s.gpu);
+        }
+        fprintf(out, " }%s\n", i+1 < r.scenes.size() ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"regressions\": [");
+    for(size_t i=0; i<regressions.size(); ++i) {
+        fprintf(out, "%s\n    \"%s\"", 0 < i ? "," : "", regressions[i].c_str());
+    }
+    fprintf(out, "%s]\n}\n", regressions.empty() ? "" : "\n  ");
+    const bool ok = 0 == ferror(out);
+    fclose(out);
+    return ok;
+}
+
+//
+// baseline, minimal JSON reader sufficient for our own output
+//
+
+struct json_t {
+    enum class type_t { null, boolean, number, string, array, object } type = type_t::null;
+    double number = 0;
+    std::string string;
+    std::vector<json_t> array;
+    std::vector<std::pair<std::string, json_t>> object;
+
+    const json_t* get(const std::string& key) const {
+        for(const std::pair<std::string, json_t>& kv : object) {
+            if( kv.first == key ) {
+                return &kv.second;
+            }
+        }
+        return nullptr;
+    }
+    double num(const std::string& key, double def=-1) const {
+        const json_t* v = get(key);
+        return nullptr != v && type_t::number == v->type ? v->number : def;
+    }
+};
+
+class json_parser_t {
+  private:
+    const std::string& m_s;
+    size_t m_pos = 0;
+
+    void skip_ws() {
+        while( m_pos < m_s.size() && 0 != std::isspace(static_cast<unsigned char>(m_s[m_pos])) ) { ++m_pos; }
+    }
+    bool parse_string(std::string& out) {
+        if( m_pos >= m_s.size() || '"' != m_s[m_pos] ) { return false; }
+        ++m_pos;
+        while( m_pos < m_s.size() && '"' != m_s[m_pos] ) {
+            if( '\\' == m_s[m_pos] && m_pos+1 < m_s.size() ) { ++m_pos; }
+            out.push_back(m_s[m_pos++]);
+        }
+        if( m_pos >= m_s.size() ) { return false; }
+        ++m_pos;
+        return true;
+    }
+
+  public:
+    explicit json_parser_t(const std::string& s) : m_s(s) {}
+
+    bool parse(json_t& v) {
+        skip_ws();
+        if( m_pos >= m_s.size() ) { return false; }
+        const char c = m_s[m_pos];
+        if( '{' == c ) {
+            v.type = json_t::type_t::object;
+            ++m_pos; skip_ws();
+            if( m_pos < m_s.size() && '}' == m_s[m_pos] ) { ++m_pos; return true; }
+            while( true ) {
+                std::pair<std::string, json_t> kv;
+                skip_ws();
+                if( !parse_string(kv.first) ) { return false; }
+                skip_ws();
+                if( m_pos >= m_s.size() || ':' != m_s[m_pos++] ) { return false; }
+                if( !parse(kv.second) ) { return false; }
+                v.object.push_back(std::move(kv));
+                skip_ws();
+                if( m_pos >= m_s.size() ) { return false; }
+                if( '}' == m_s[m_pos] ) { ++m_pos; return true; }
+                if( ',' != m_s[m_pos++] ) { return false; }
+            }
+        } else if( '[' == c ) {
+            v.type = json_t::type_t::array;
+            ++m_pos; skip_ws();
+            if( m_pos < m_s.size() && ']' == m_s[m_pos] ) { ++m_pos; return true; }
+            while( true ) {
+                json_t e;
+                if( !parse(e) ) { return false; }
+                v.array.push_back(std::move(e));
+                skip_ws();
+                if( m_pos >= m_s.size() ) { return false; }
+                if( ']' == m_s[m_pos] ) { ++m_pos; return true; }
+                if( ',' != m_s[m_pos++] ) { return false; }
+            }
+        } else if( '"' == c ) {
+            v.type = json_t::type_t::string;
+            return parse_string(v.string);
+        } else if( 0 == m_s.compare(m_pos, 4, "true") || 0 == m_s.compare(m_pos, 5, "false") ) {
+            v.type = json_t::type_t::boolean;
+            v.number = 't' == c ? 1 : 0;
+            m_pos += 't' == c ? 4 : 5;
+            return true;
+        } else if( 0 == m_s.compare(m_pos, 4, "null") ) {
+            m_pos += 4;
+            return true;
+        } else {
+            char* end = nullptr;
+            v.type = json_t::type_t::number;
+            v.number = std::strtod(m_s.c_str() + m_pos, &end);
+            if( end == m_s.c_str() + m_pos ) { return false; }
+            m_pos = static_cast<size_t>(end - m_s.c_str());
+            return true;
+        }
+    }
+};
+
+static bool read_json(const std::string& path, json_t& v) {
+    FILE* in = fopen(path.c_str(), "r");
+    if( nullptr == in ) {
+        printf("Bench: Error opening baseline %s\n", path.c_str());
+        return false;
+    }
+    std::string s;
+    char buf[4096];
+    size_t n;
+    while( 0 < ( n = fread(buf, 1, sizeof(buf), in) ) ) {
+        s.append(buf, n);
+    }
+    fclose(in);
+    json_parser_t p(s);
+    if( !p.parse(v) || json_t::type_t::object != v.type ) {
+        printf("Bench: Error parsing baseline %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/** Flags value as regression if exceeding baseline by more than threshold [0..1] and min_abs. */
+static void compare(std::vector<std::string>& regressions, const std::string& what,
+                    double value, double baseline, double threshold, double min_abs) {
+    if( 0 > baseline ) {
+        return;
+    }
+    const bool regressed = value > baseline * (1.0 + threshold) && value - baseline > min_abs;
+    printf("  %-28s %12.4f -> %12.4f  %+7.1f%%%s\n", what.c_str(), baseline, value,
+           0 < baseline ? (value - baseline) * 100.0 / baseline : 0.0, regressed ? "  REGRESSION" : "");
+    if( regressed ) {
+        regressions.push_back(what);
+    }
+}
+
+static std::vector<std::string> compare_baseline(const bench_result_t& r, const json_t& base, double threshold) {
+    std::vector<std::string> regressions;
+    printf("Baseline comparison, threshold %.1f%%\n", threshold * 100.0);
+    compare(regressions, "startup_ms", r.startup_ms, base.num("startup_ms"), threshold, 5.0);
+    compare(regressions, "peak_rss_kb", static_cast<double>(r.peak_rss_kb), base.num("peak_rss_kb"), threshold, 1024.0);
+    const json_t* scenes = base.get("scenes");
+    for(const scene_result_t& s : r.scenes) {
+        const json_t* bs = nullptr;
+        if( nullptr != scenes ) {
+            for(const json_t& e : scenes->array) {
+                const json_t* name = e.get("name");
+                if( nullptr != name && name->string == s.name ) {
+                    bs = &e;
+                }
+            }
+        }
+        if( nullptr == bs ) {
+            printf("  %s: not in baseline\n", s.name.c_str());
+            continue;
+        }
+        const auto cmp = [&](const char* group, const char* key, double value_ms) {
+            const json_t* g = bs->get(group);
+            if( nullptr != g ) {
+                compare(regressions, s.name+"."+group+"."+key, value_ms, g->num(key), threshold, 0.05);
+            }
+        };
+        cmp("frame_ms", "p50", s.frame.p50 * 1000.0);
+        cmp("frame_ms", "p95", s.frame.p95 * 1000.0);
+        cmp("frame_ms", "p99", s.frame.p99 * 1000.0);
+        cmp("cpu_ms", "p95", s.cpu.p95 * 1000.0);
+        if( s.has_gpu ) {
+            cmp("gpu_ms", "p95", s.gpu.p95 * 1000.0);
+        }
+    }
+    return regressions;
+}
+
+//
+// runner
+//
+
+static bool run_scene(const scene_t& scene, uint64_t max_frames, int64_t max_duration_ms, scene_result_t& res) {
+    static gamp::input_event_t event;
+    constexpr uint64_t warmup_frames = 30;
+
+    printf("Bench: Scene %s\n", scene.name);
+    if( !scene.init() ) {
+        printf("Bench: Scene %s init failed\n", scene.name);
+        return false;
+    }
+    for(uint64_t i=0; i<warmup_frames; ++i) {
+        scene.render(i);
+        gamp::swap_gpu_buffer();
+    }
+    gamp::end_gpu_stats_period();  // discard warmup
+
+    gamp::duration_histogram_t cpu_histogram;
+    const jau::fraction_timespec t0 = jau::getMonotonicTime();
+    uint64_t frame = 0;
+    bool closed = false;
+    while( ( 0 == max_frames || frame < max_frames ) &&
+           ( 0 == max_duration_ms || (jau::getMonotonicTime() - t0).to_ms() < max_duration_ms ) ) {
+        gamp::handle_events(event);
+        if( event.pressed_and_clr( gamp::input_event_type_t::WINDOW_CLOSE_REQ ) ) {
+            closed = true;
+            break;
+        }
+        const jau::fraction_timespec t_a = jau::getMonotonicTime();
+        scene.render(warmup_frames + frame);
+        cpu_histogram.add(static_cast<uint64_t>((jau::getMonotonicTime() - t_a).to_us()));
+        gamp::swap_gpu_buffer();
+        ++frame;
+    }
+    const jau::fraction_timespec t1 = jau::getMonotonicTime();
+    gamp::end_gpu_stats_period();
+    scene.dispose();
+
+    res.name = scene.name;
+    res.frames = frame;
+    res.duration_ms = static_cast<double>((t1 - t0).to_us()) / 1000.0;
+    res.fps = gamp::get_gpu_stats_fps();
+    res.frame = gamp::get_gpu_stats_frame_percentiles();
+    res.cpu = cpu_histogram.percentiles(0);
+    res.has_gpu = gamp::has_gpu_timer_query();
+    res.gpu = gamp::get_gpu_stats_gpu_percentiles();
+    printf("Bench: Scene %s: %" PRIu64 " frames, %.1f fps, frame %s\n", scene.name, frame, res.fps, res.frame.toString().c_str());
+    return !closed;
+}
+
+static void print_usage() {
+    printf("gamp_bench [-headless] [-width <px>] [-height <px>] [-vsync] [-fps <fps>]\n"
+           "           [-scene <name>]* [-frames <count>] [-duration <ms>]\n"
+           "           [-out <result.json>] [-baseline <baseline.json>] [-threshold <percent>]\n");
+    printf("Scenes:");
+    for(const scene_t& s : all_scenes) {
+        printf(" %s", s.name);
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const jau::fraction_timespec t_start = jau::getMonotonicTime();
+    int width = 1280, height = 720;
+    bool headless = false, vsync = false;
+    uint64_t max_frames = 0;
+    int64_t max_duration_ms = 0;
+    double threshold = 0.10;
+    std::string out_file = "gamp_bench.json", baseline_file;
+    std::vector<const scene_t*> scenes;
+    {
+        for(int i=1; i<argc; ++i) {
+            if( 0 == strcmp("-headless", argv[i]) ) {
+                headless = true;
+            } else if( 0 == strcmp("-vsync", argv[i]) ) {
+                vsync = true;
+            } else if( 0 == strcmp("-width", argv[i]) && i+1<argc) {
+                width = atoi(argv[++i]);
+            } else if( 0 == strcmp("-height", argv[i]) && i+1<argc) {
+                height = atoi(argv[++i]);
+            } else if( 0 == strcmp("-fps", argv[i]) && i+1<argc) {
+                gamp::forced_fps = atoi(argv[++i]);
+            } else if( 0 == strcmp("-frames", argv[i]) && i+1<argc) {
+                max_frames = static_cast<uint64_t>(atoll(argv[++i]));
+            } else if( 0 == strcmp("-duration", argv[i]) && i+1<argc) {
+                max_duration_ms = atoll(argv[++i]);
+            } else if( 0 == strcmp("-out", argv[i]) && i+1<argc) {
+                out_file = argv[++i];
+            } else if( 0 == strcmp("-baseline", argv[i]) && i+1<argc) {
+                baseline_file = argv[++i];
+            } else if( 0 == strcmp("-threshold", argv[i]) && i+1<argc) {
+                threshold = atof(argv[++i]) / 100.0;
+            } else if( 0 == strcmp("-scene", argv[i]) && i+1<argc) {
+                const char* name = argv[++i];
+                const scene_t* found = nullptr;
+                for(const scene_t& s : all_scenes) {
+                    if( 0 == strcmp(s.name, name) ) {
+                        found = &s;
+                    }
+                }
+                if( nullptr == found ) {
+                    printf("Bench: Unknown scene %s\n", name);
+                    print_usage();
+                    return 1;
+                }
+                scenes.push_back(found);
+            } else {
+                print_usage();
+                return 1;
+            }
+        }
+        if( 0 == max_frames && 0 == max_duration_ms ) {
+            max_frames = 600;
+        }
+        if( scenes.empty() ) {
+            for(const scene_t& s : all_scenes) {
+                scenes.push_back(&s);
+            }
+        }
+    }
+    const bool init_ok = headless ? gamp::init_gfx_subsystem_headless(width, height)
+                                  : gamp::init_gfx_subsystem("gamp_bench", width, height, vsync);
+    if( !init_ok ) {
+        printf("Exit...");
+        return 1;
+    }
+    bench_result_t result;
+    result.startup_ms = static_cast<double>((jau::getMonotonicTime() - t_start).to_us()) / 1000.0;
+    gamp::set_gpu_stats_period(24 * 3600 * 1000);  // periods end per scene only
+
+    bool ok = true;
+    for(const scene_t* s : scenes) {
+        scene_result_t res;
+        ok = run_scene(*s, max_frames, max_duration_ms, res);
+        if( !ok ) {
+            break;
+        }
+        result.scenes.push_back(res);
+    }
+    {
+        struct rusage usage;
+        if( 0 == getrusage(RUSAGE_SELF, &usage) ) {
+            result.peak_rss_kb = usage.ru_maxrss;
+        }
+    }
+    std::vector<std::string> regressions;
+    if( ok && !baseline_file.empty() ) {
+        json_t baseline;
+        if( !read_json(baseline_file, baseline) ) {
+            return 1;
+        }
+        regressions = compare_baseline(result, baseline, threshold);
+    }
+    if( !write_json(out_file, result, regressions) ) {
+        printf("Bench: Error writing %s\n", out_file.c_str());
+        return 1;
+    }
+    printf("Bench: Wrote %s, startup %.1fms, peak RSS %" PRIi64 " KiB, %zu regressions\n",
+           out_file.c_str(), result.startup_ms, result.peak_rss_kb, regressions.size());
+    if( !ok ) {
+        return 1;
+    }
+    return regressions.empty() ? 0 : 2;
+}
@@ -26,7 +26,9 @@
 #include <random>
 #include <cstdio>
 #include <cmath>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include <GLES2/gl2.h>
 #include <SDL2/SDL_opengles2.h>
@@ -133,17 +135,21 @@ void updatePMv(const PMVMat4f& pmv)
     glUniformMatrix4fv(u_pmv, (GLsizei)spmv.matrixCount(), false, spmv.floats());
 }
 
-void reshape(RenderContext& rc) {
-    rc.pmv().getP().loadIdentity();
+void reshape(PMVMat4f& pmv, int width, int height) {
+    pmv.getP().loadIdentity();
 
     const float aspect = 1.0f;
     const float fovy_deg=45.0f;
-    const float aspect2 = ( (float) rc.viewport().width() / (float) rc.viewport().height() ) / aspect;
+    const float aspect2 = ( (float) width / (float) height ) / aspect;
     const float zNear=1.0f;
     const float zFar=100.0f;
-    rc.pmv().perspectiveP(jau::adeg_to_rad(fovy_deg), aspect2, zNear, zFar);
+    pmv.perspectiveP(jau::adeg_to_rad(fovy_deg), aspect2, zNear, zFar);
     
-    updatePMv(rc.pmv());
+    updatePMv(pmv);
+}
+
+void reshape(RenderContext& rc) {
+    reshape(rc.pmv(), rc.viewport().width(), rc.viewport().height());
 }
 
 bool initialize(RenderContext& rc)
@@ -201,47 +207,171 @@ bool initialize(RenderContext& rc)
     return shaderProgram;
 }
 
+static std::string trace_file;
+static bool use_controller = false;
+static std::string record_file, replay_file;
+static gamp::replay_mode_t replay_mode = gamp::replay_mode_t::realtime;
+
+/** Sets the modelview of the square, rotated by given angle and panned towards given normalized [-1..1] pointer position. */
+void setMv(PMVMat4f& pmv, float ang, float px, float py) {
+    pmv.getMv().loadIdentity();
+    pmv.translateMv(px * 2.0f, py * 2.0f, -10);
+    pmv.rotateMv(ang, 0, 0, 1);
+    pmv.rotateMv(ang, 0, 1, 0);
+}
+
+/** Sets the modelview of the square, rotated by given angle and panned towards the pointer position if available. */
+void setMv(PMVMat4f& pmv, float ang, const gamp::input_event_t& event) {
+    if( 0 <= event.pointer_x && 0 < gamp::win_width && 0 < gamp::win_height ) {
+        const float px = 2.0f * (float)event.pointer_x / (float)gamp::win_width - 1.0f;
+        const float py = 1.0f - 2.0f * (float)event.pointer_y / (float)gamp::win_height;
+        setMv(pmv, ang, px, py);
+    } else {
+        setMv(pmv, ang, 0, 0);
+    }
+}
+
+static bool use_render_thread = false;
+static RenderContext* render_thread_ctx = nullptr;
+
+/** Frame data built by the event thread for the render thread, see gamp::submit_frame(). */
+struct frame_t {
+    float ang;
+    /** Pointer position in window units, negative if none. */
+    int pointer_x, pointer_y;
+    /** True if the window has been resized, the viewport is updated by the render thread before rendering this frame. */
+    bool resized;
+};
+
+/** Renders given frame on the render thread. */
+void render_frame(const frame_t& f) {
+    PMVMat4f& pmv = render_thread_ctx->pmv();
+    if( f.resized ) {
+        reshape(pmv, gamp::viewport.width(), gamp::viewport.height());
+    }
+    gamp::begin_scene(); // no-op unless enabled via -dynres
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    const bool has_pointer = 0 <= f.pointer_x && 0 < gamp::win_width && 0 < gamp::win_height;
+    const float px = has_pointer ? 2.0f * (float)f.pointer_x / (float)gamp::win_width - 1.0f : 0.0f;
+    const float py = has_pointer ? 1.0f - 2.0f * (float)f.pointer_y / (float)gamp::win_height : 0.0f;
+    setMv(pmv, f.ang, px, py);
+    updatePMv(pmv);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    gamp::end_scene();
+}
+
+/** Simulation steps per second, independent of the frame rate. */
+static int sim_rate = 120;
+
+static bool use_sim_thread = false;
+/** Angle in degrees published by the simulation thread, see -simthread. */
+static gamp::triple_buffer_t<float> sim_ang_deg;
+
+/** Simulation thread consuming the input snapshot published by handle_events(), see gamp::input_snapshot(). */
+void simulate() {
+    const float dt = 1.0f / (float)sim_rate;
+    float ang_deg = 0;
+    gamp::input_snapshot_t& input = gamp::input_snapshot();
+    while( true ) {
+        if( input.update() && input.front().pressed_in_frame( gamp::input_event_type_t::RESET ) ) {
+            ang_deg = 0; // edge triggered, not lost if pressed and released between two steps
+        }
+        if( !input.front().paused() ) {
+            ang_deg = std::fmod(ang_deg + dt * 90.0f, 360.0f); // 90 degrees per second
+        }
+        sim_ang_deg.publish(ang_deg);
+        std::this_thread::sleep_for(std::chrono::nanoseconds(1000000000 / sim_rate));
+    }
+}
+
+/** Returns the angle in radians of the simulation thread if used, otherwise the interpolated angle of given simulation steps. */
+float frame_angle(float ang_deg_prev, float ang_deg, float alpha) {
+    if( use_sim_thread ) {
+        sim_ang_deg.update();
+        return jau::adeg_to_rad(sim_ang_deg.front());
+    }
+    return jau::adeg_to_rad(ang_deg_prev + ( ang_deg - ang_deg_prev ) * alpha);
+}
+
 void mainloop() {
-    static uint64_t t_sum = 0;
-    static uint64_t t_last = jau::environment::getElapsedMillisecond(); // [ms]
+    static gamp::fixed_step_loop_t loop(jau::fraction_timespec(0, 1000000000 / sim_rate));
+    static float ang_deg_prev = 0, ang_deg = 0; // simulation state, previous and current step
     static gamp::input_event_t event;
     static RenderContext renderContext(initialize);
+    static bool resized = false;
+
+    if( use_render_thread && !gamp::has_render_thread() ) {
+        // GL resources have been initialized on this thread, the context moves to the render thread
+        render_thread_ctx = &renderContext;
+        use_render_thread = gamp::start_render_thread(2);
+    }
 
+    if( gamp::get_event_pump() ) {
+        gamp::pump_events(); // same thread producer, queued events are drained by handle_events()
+    }
     gamp::handle_events(event);
+    gamp::poll_controllers(event); // no-op unless enabled via -controller
     if( event.pressed_and_clr( gamp::input_event_type_t::WINDOW_CLOSE_REQ ) ) {
         printf("Exit Application\n");
+        gamp::stop_render_thread();
+        if( !trace_file.empty() ) {
+            gamp::profile::write_chrome_trace(trace_file);
+        }
+        gamp::stop_input_recording();
         #if defined(__EMSCRIPTEN__)
             emscripten_cancel_main_loop();
         #else
             exit(0);
         #endif
     } else if( event.pressed_and_clr( gamp::input_event_type_t::WINDOW_RESIZED ) ) {
-        reshape(renderContext);
+        if( gamp::has_render_thread() ) {
+            resized = true;
+        } else {
+            reshape(renderContext);
+        }
     }
-    const bool animating = !event.paused();
+    loop.set_paused(event.paused());
 
-    const uint64_t t1 = jau::environment::getElapsedMillisecond(); // [ms]
-    const uint64_t dt = animating ? t1 - t_last : 0; // [ms]
-    t_sum += dt;
-    t_last = t1;
+    loop.frame(
+        [&](float dt) {
+            ang_deg_prev = ang_deg;
+            ang_deg = std::fmod(ang_deg + dt * 90.0f, 360.0f); // 90 degrees per second
+            if( ang_deg < ang_deg_prev ) {
+                ang_deg_prev -= 360.0f;
+            }
+        },
+        [&](float alpha) {
+            if( gamp::has_render_thread() ) {
+                frame_t f;
+                f.ang = frame_angle(ang_deg_prev, ang_deg, alpha);
+                f.pointer_x = event.pointer_x;
+                f.pointer_y = event.pointer_y;
+                f.resized = resized;
+                resized = false;
+                gamp::submit_frame(render_frame, f);
+                return;
+            }
+            GAMP_PROFILE_ZONE("render");
+            gamp::begin_scene(); // no-op unless enabled via -dynres
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);    
-        
-        PMVMat4f& pmv = renderContext.pmv();
-        pmv.getMv().loadIdentity();
-        pmv.translateMv(0, 0, -10);
-        
-        const float ang = jau::adeg_to_rad(static_cast<float>(t_sum) * 360.0f) / 4000.0f;
-        pmv.rotateMv(ang, 0, 0, 1);
-        pmv.rotateMv(ang, 0, 1, 0);
-            
-        updatePMv(pmv);
-        
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    }
+            PMVMat4f& pmv = renderContext.pmv();
+            const float ang = frame_angle(ang_deg_prev, ang_deg, alpha);
+            setMv(pmv, ang, event);
+            updatePMv(pmv);
 
-    gamp::swap_gpu_buffer();
+            // late-latch pointer motion received while rendering, patching the modelview right before the draw call
+            if( gamp::latch_pointer_motion(event) ) {
+                setMv(pmv, ang, event);
+                updatePMv(pmv);
+            }
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            gamp::end_scene();
+        });
+
+    if( !gamp::has_render_thread() ) {
+        gamp::swap_gpu_buffer();
+    }
 }
 
 int main(int argc, char *argv[])
@@ -261,9 +391,41 @@ int main(int argc, char *argv[])
             } else if( 0 == strcmp("-fps", argv[i]) && i+1<argc) {
                 gamp::forced_fps = atoi(argv[i+1]);
                 ++i;
+            } else if( 0 == strcmp("-simrate", argv[i]) && i+1<argc) {
+                sim_rate = std::max(1, atoi(argv[i+1]));
+                ++i;
+            } else if( 0 == strcmp("-keys", argv[i]) && i+1<argc) {
+                gamp::load_key_bindings(argv[i+1]);
+                ++i;
+            } else if( 0 == strcmp("-controller", argv[i]) ) {
+                use_controller = true;
+            } else if( 0 == strcmp("-coalesce", argv[i]) ) {
+                gamp::set_motion_coalescing(true);
+            } else if( 0 == strcmp("-render_thread", argv[i]) ) {
+                use_render_thread = true;
+            } else if( 0 == strcmp("-simthread", argv[i]) ) {
+                use_sim_thread = true;
+            } else if( 0 == strcmp("-pump", argv[i]) ) {
+                gamp::set_event_pump(true);
+            } else if( 0 == strcmp("-governor", argv[i]) ) {
+                gamp::set_fps_governor(true);
+            } else if( 0 == strcmp("-dynres", argv[i]) ) {
+                gamp::set_dynamic_resolution(true);
+            } else if( 0 == strcmp("-record", argv[i]) && i+1<argc) {
+                record_file = argv[i+1];
+                ++i;
+            } else if( 0 == strcmp("-replay", argv[i]) && i+1<argc) {
+                replay_file = argv[i+1];
+                ++i;
+            } else if( 0 == strcmp("-replay_fast", argv[i]) ) {
+                replay_mode = gamp::replay_mode_t::fast;
+            } else if( 0 == strcmp("-trace", argv[i]) && i+1<argc) {
+                trace_file = argv[i+1];
+                ++i;
             }
         }
         printf("-fps: %d\n", gamp::forced_fps);
+        printf("-simrate: %d\n", sim_rate);
     }
     gamp::set_gpu_stats_show(true);
     
@@ -271,6 +433,23 @@ int main(int argc, char *argv[])
         printf("Exit...");
         return 1;
     }    
+    if( use_controller ) {
+        gamp::init_controller_subsystem();
+    }
+    if( !record_file.empty() ) {
+        gamp::start_input_recording(record_file);
+    }
+    if( !replay_file.empty() ) {
+        gamp::start_input_replay(replay_file, replay_mode);
+    }
+    #if !defined(__EMSCRIPTEN__)
+        if( use_sim_thread ) {
+            gamp::set_input_snapshot_publish(true);
+            std::thread(simulate).detach(); // runs until exit
+        }
+    #else
+        use_sim_thread = false;
+    #endif
     {
         const int w = gamp::viewport.width();
         const int h = gamp::viewport.width();
@@ -0,0 +1,87 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_CONTROLLER_HPP_
+#define JAU_GAMP_CONTROLLER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gamp {
+
+    /** Analog game controller axis. */
+    enum class controller_axis_t : uint8_t {
+        left_x,
+        left_y,
+        right_x,
+        right_y,
+        trigger_left,
+        trigger_right
+    };
+    constexpr size_t controller_axis_count = 6;
+
+    /** Digital game controller button, bit number within controller_snapshot_t::buttons. */
+    enum class controller_button_t : uint8_t {
+        a,
+        b,
+        x,
+        y,
+        back,
+        guide,
+        start,
+        left_stick,
+        right_stick,
+        left_shoulder,
+        right_shoulder,
+        dpad_up,
+        dpad_down,
+        dpad_left,
+        dpad_right
+    };
+    constexpr uint32_t bitmask(const controller_button_t b) noexcept {
+        return 1U << static_cast<uint32_t>(b);
+    }
+
+    /**
+     * Struct-of-arrays snapshot of all game controllers, polled once per frame, see poll_controllers().
+     *
+     * Controller slot 0 and 1 map to the player 1 and 2 actions of input_event_t.
+     */
+    struct controller_snapshot_t {
+        constexpr static size_t capacity = 4;
+
+        /** True if the slot is connected. */
+        std::array<bool, capacity> connected{};
+        /** Analog axes per axis and slot, i.e. `axes[axis][slot]`, deadzone filtered and normalized to [-1..1] sticks and [0..1] triggers. */
+        std::array<std::array<float, capacity>, controller_axis_count> axes{};
+        /** Pressed buttons per slot, see bitmask(controller_button_t). */
+        std::array<uint32_t, capacity> buttons{};
+
+        float axis(size_t slot, controller_axis_t a) const noexcept { return axes[static_cast<size_t>(a)][slot]; }
+        bool pressed(size_t slot, controller_button_t b) const noexcept { return 0 != (buttons[slot] & bitmask(b)); }
+    };
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_CONTROLLER_HPP_ */
@@ -0,0 +1,162 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_DURATION_STATS_HPP_
+#define JAU_GAMP_DURATION_STATS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace gamp {
+
+    /** Percentiles of a duration distribution in seconds, e.g. frame times. */
+    struct duration_percentiles_t {
+        /** Number of samples */
+        uint64_t count = 0;
+        /** Number of samples exceeding the budget, see producer for its definition. */
+        uint64_t over_budget = 0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+
+        std::string toString() const noexcept;
+    };
+    inline std::string to_string(const duration_percentiles_t& p) noexcept { return p.toString(); }
+
+    /**
+     * Allocation free histogram of durations in microseconds using logarithmic buckets.
+     *
+     * Each power of two octave is split into 16 linear sub-buckets,
+     * i.e. a relative resolution of 6.25% within [1us, 2^27us ~ 134s].
+     */
+    class duration_histogram_t {
+        public:
+            constexpr static int sub_bits = 4;
+            constexpr static uint64_t sub_count = 1U << sub_bits;
+            constexpr static int octaves = 27;
+            constexpr static size_t bucket_count = octaves * sub_count;
+
+            /** Returns the bucket index for given duration in microseconds. */
+            constexpr static size_t index_of(uint64_t us) noexcept {
+                if (us < 1) {
+                    return 0;
+                }
+                const uint64_t octave = std::bit_width(us) - 1;
+                const uint64_t sub = ((us << sub_bits) >> octave) & (sub_count - 1);
+                return std::min<size_t>(octave * sub_count + sub, bucket_count - 1);
+            }
+            /** Returns the inclusive lower bound of given bucket index in microseconds. */
+            constexpr static uint64_t lower_bound(size_t idx) noexcept {
+                const uint64_t octave = idx >> sub_bits;
+                const uint64_t sub = idx & (sub_count - 1);
+                return ((sub_count + sub) << octave) >> sub_bits;
+            }
+
+        private:
+            std::array<uint32_t, bucket_count> m_buckets;
+            uint64_t m_count;
+            uint64_t m_max_us;
+
+        public:
+            duration_histogram_t() noexcept { clear(); }
+
+            void clear() noexcept {
+                m_buckets.fill(0);
+                m_count = 0;
+                m_max_us = 0;
+            }
+            void add(uint64_t us) noexcept {
+                ++m_buckets[index_of(us)];
+                ++m_count;
+                m_max_us = std::max(m_max_us, us);
+            }
+            uint64_t count() const noexcept { return m_count; }
+            uint64_t max_us() const noexcept { return m_max_us; }
+
+            /** Returns the center of the bucket holding given percentile [0..1] in microseconds, clipped to max_us(). */
+            uint64_t percentile_us(double p) const noexcept {
+                if (0 == m_count) {
+                    return 0;
+                }
+                const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(m_count))));
+                uint64_t sum = 0;
+                for (size_t i = 0; i < bucket_count; ++i) {
+                    sum += m_buckets[i];
+                    if (sum >= target) {
+                        return std::min((lower_bound(i) + lower_bound(i + 1)) / 2, m_max_us);
+                    }
+                }
+                return m_max_us;
+            }
+            /** Returns p50, p95, p99 and max, with given over_budget count. */
+            duration_percentiles_t percentiles(uint64_t over_budget) const noexcept {
+                duration_percentiles_t r;
+                r.count = m_count;
+                r.over_budget = over_budget;
+                r.p50 = static_cast<double>(percentile_us(0.50)) / 1000000.0;
+                r.p95 = static_cast<double>(percentile_us(0.95)) / 1000000.0;
+                r.p99 = static_cast<double>(percentile_us(0.99)) / 1000000.0;
+                r.max = static_cast<double>(m_max_us) / 1000000.0;
+                return r;
+            }
+    };
+
+    /** Allocation free ring of the most recent N durations in microseconds. */
+    template<size_t N>
+    class duration_ring_t {
+        private:
+            std::array<uint32_t, N> m_samples;
+            size_t m_pos = 0;
+            size_t m_size = 0;
+
+        public:
+            constexpr static size_t capacity() noexcept { return N; }
+
+            size_t size() const noexcept { return m_size; }
+            void clear() noexcept { m_pos = 0; m_size = 0; }
+            void add(uint64_t us) noexcept {
+                m_samples[m_pos] = static_cast<uint32_t>(std::min<uint64_t>(us, UINT32_MAX));
+                m_pos = (m_pos + 1) % N;
+                m_size = std::min(m_size + 1, N);
+            }
+            /** Copies the most recent samples into dest, oldest first, returning the number of copied samples. */
+            size_t copy_to(std::span<uint32_t> dest) const noexcept {
+                const size_t n = std::min(dest.size(), m_size);
+                size_t idx = (m_pos + N - n) % N;
+                for (size_t i = 0; i < n; ++i) {
+                    dest[i] = m_samples[idx];
+                    idx = (idx + 1) % N;
+                }
+                return n;
+            }
+    };
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_DURATION_STATS_HPP_ */
@@ -25,6 +25,14 @@
 #define JAU_GAMP_HPP_
 
 #include <gamp/gamp_types.hpp>
+#include <gamp/controller.hpp>
+#include <gamp/duration_stats.hpp>
+#include <gamp/gl_caps.hpp>
+#include <gamp/log.hpp>
+#include <gamp/loop.hpp>
+#include <gamp/pointer.hpp>
+#include <gamp/profile.hpp>
+#include <gamp/triple_buffer.hpp>
 #include <gamp/version.hpp>
 
 /**
@@ -58,21 +66,320 @@ namespace gamp {
 
     /** GFX Toolkit: Initialize a window of given size with a usable framebuffer. */
     bool init_gfx_subsystem(const char* title, int window_width, int window_height, bool enable_vsync = true);
-    /** GFX Toolkit: Swap GPU back to front framebuffer using given fps, maintaining vertical monitor synchronization if possible. fps <= 0 implies automatic fps. */
+    /**
+     * GFX Toolkit: Initialize a headless GL context rendering into an offscreen framebuffer of given size in pixels, i.e. without a display.
+     *
+     * Uses SDL's offscreen video driver, i.e. an EGL pbuffer or surfaceless context like Mesa llvmpipe, if available,
+     * otherwise a hidden window.
+     *
+     * viewport and swap_gpu_buffer() behave as with init_gfx_subsystem(),
+     * however, swap_gpu_buffer() waits for the rendering to complete instead of presenting it.
+     * Rendering shall target default_framebuffer().
+     *
+     * Not supported on WebAssembly.
+     */
+    bool init_gfx_subsystem_headless(int fb_width, int fb_height);
+    /** Returns true if initialized via init_gfx_subsystem_headless(). */
+    bool is_headless() noexcept;
+    /** Returns the GL framebuffer object name of the default render target, i.e. 0 for the window or the offscreen framebuffer if is_headless(). */
+    uint32_t default_framebuffer() noexcept;
+
+    /** Opaque additional window surface, see create_surface(). */
+    struct surface_t;
+
+    /** State of an additional window surface, see get_surface_info(). */
+    struct surface_info_t {
+        /** Window id as used by event_t::window_id. */
+        uint32_t window_id = 0;
+        /** Size of the window in window units. */
+        int win_width = 0;
+        int win_height = 0;
+        /** Framebuffer size in pixels. */
+        jau::math::Recti viewport;
+        /** Number of applied resizes, allowing to detect a resize since the last frame. */
+        uint64_t resize_count = 0;
+        /** True if the user requested to close the window, which then should be destroyed by the caller. */
+        bool close_requested = false;
+        /** Presented frames per seconds, averaged over get_gpu_stats_period(). */
+        float fps = 0.0f;
+        /** Costs per frame of presenting in seconds, averaged over get_gpu_stats_period(). */
+        double swap_costs = 0.0;
+    };
+
+    /**
+     * GFX Toolkit: Creates an additional window of given size with its own GL context, sharing GL objects with the primary window.
+     *
+     * Textures, buffers and shader programs of the primary context are usable in all surfaces,
+     * container objects like vertex array or framebuffer objects are not shared.
+     * Render into the surface after make_surface_current(), swap_gpu_buffer() presents all surfaces in one pass
+     * with the primary window being current afterwards. Only the primary window is synchronized to vsync,
+     * i.e. all surfaces are presented at the primary's frame rate.
+     *
+     * Window close and resize events of the surface update its surface_info_t instead of the input_event_t actions,
+     * other input events are distinguished via event_t::window_id.
+     *
+     * Shall be called on the thread polling events after init_gfx_subsystem(), not supported if headless or on WebAssembly.
+     * Fails while the render thread is running, see start_render_thread().
+     * @return the new surface or nullptr on failure
+     */
+    surface_t* create_surface(const char* title, int window_width, int window_height) noexcept;
+    /** GFX Toolkit: Destroys given surface and its GL context, see create_surface(). The primary window becomes current. Ignored while the render thread is running. */
+    void destroy_surface(surface_t* s) noexcept;
+    /**
+     * GFX Toolkit: Makes the GL context of given surface current and sets its viewport.
+     * @param s the surface or nullptr for the primary window
+     * @return true if successful
+     */
+    bool make_surface_current(surface_t* s) noexcept;
+    /**
+     * Returns a copy of the state of given surface, see create_surface().
+     *
+     * Shall be called on the thread handling events, which owns the window state.
+     * fps and swap_costs are published per period by the thread presenting the surfaces, e.g. the render thread.
+     */
+    surface_info_t get_surface_info(const surface_t* s) noexcept;
+    /**
+     * GFX Toolkit: Swap GPU back to front framebuffer using given fps, maintaining vertical monitor synchronization if possible. fps <= 0 implies automatic fps.
+     *
+     * Given fps > 0, frames are paced against absolute deadlines spaced 1/fps apart, avoiding drift.
+     * Missing a deadline by one or more frame periods skips the missed frames instead of catching up with a burst.
+     */
     void swap_gpu_buffer(int fps) noexcept;
     /** GFX Toolkit: Swap GPU back to front framebuffer using forced_fps, maintaining vertical monitor synchronization if possible. */
     inline void swap_gpu_buffer() noexcept { swap_gpu_buffer(forced_fps); }
 
-    /** Returns frames per seconds, averaged over get_gpu_stat_period(). */
+    /** Maximum number of frames in flight of the render thread, see start_render_thread(). */
+    constexpr size_t render_queue_capacity = 4;
+
+    /** Type erased frame of the render thread, holding a render function and a trivially copyable copy of its data. See submit_frame(). */
+    struct render_frame_t {
+        constexpr static size_t data_capacity = 256;
+        /** Invokes the render function with the data. */
+        void (*invoke)(const render_frame_t& self) noexcept = nullptr;
+        /** Render function, cast to its signature by invoke. */
+        void (*fn)() = nullptr;
+        /** Frames per second passed to swap_gpu_buffer(). */
+        int fps = -1;
+        /** OS timestamp in nanoseconds of the oldest input consumed by this frame, zero if none. Set by submit_render_frame(). */
+        int64_t input_t0_ns = 0;
+        /** Resize of the primary window applied before rendering the frame. */
+        struct resize_t {
+            bool pending = false;
+            /** Window size in window units. */
+            int win_width = 0;
+            int win_height = 0;
+            /** Framebuffer size in pixels. */
+            int fb_width = 0;
+            int fb_height = 0;
+            /** Refresh rate of a changed display, 0 if unchanged. */
+            int display_fps = 0;
+        };
+        /** Resize of the primary window since the previous frame, if pending. Set by submit_render_frame(). */
+        resize_t resize;
+        alignas(std::max_align_t) std::array<std::byte, data_capacity> data;
+    };
+
+    /**
+     * GFX Toolkit: Starts the opt-in render thread, taking over the primary GL context from the calling thread.
+     *
+     * The calling thread remains the event thread, handling events and building frames submitted via submit_frame().
+     * The render thread executes the frames in order with the GL context current, each followed by swap_gpu_buffer().
+     * Hence building frame N+1 overlaps rendering and presenting frame N, e.g. waiting for vsync.
+     *
+     * submit_frame() blocks while max_frames_in_flight frames are submitted but not yet presented,
+     * bounding latency and memory.
+     *
+     * While running, GL functions including make_surface_current() shall only be called within frames
+     * and SDL event functions only on the event thread.
+     * A resize of the primary window is handed to the render thread with the next submitted frame,
+     * i.e. win_width, win_height, viewport and display_frames_per_sec are updated by the render thread and shall be read within frames.
+     * Surfaces shall be created before and destroyed after the render thread runs, as it owns the primary context
+     * and presents the surfaces, i.e. create_surface() fails and destroy_surface() is ignored meanwhile.
+     * Statistics are published by the render thread per period and frame, the get_gpu_stats_*() getters acquire a consistent snapshot.
+     * Not supported on WebAssembly, some platforms like macOS may not support presenting off the main thread.
+     *
+     * @param max_frames_in_flight [1 .. render_queue_capacity]
+     * @return true if started, false on failure, keeping the GL context on the calling thread
+     */
+    bool start_render_thread(size_t max_frames_in_flight = 2) noexcept;
+    /** GFX Toolkit: Renders all submitted frames, stops the render thread and makes the GL context current on the calling thread again. */
+    void stop_render_thread() noexcept;
+    /** Returns true if the render thread is running, see start_render_thread(). */
+    bool has_render_thread() noexcept;
+    /** GFX Toolkit: Submits given frame to the render thread, blocking while the maximum frames are in flight. Returns false if not running. */
+    bool submit_render_frame(const render_frame_t& frame) noexcept;
+
+    /**
+     * GFX Toolkit: Submits a frame to the render thread, rendering with a copy of given data, see start_render_thread().
+     *
+     * @tparam T trivially copyable frame data, e.g. the interpolated simulation state, of up to render_frame_t::data_capacity bytes
+     * @param render function called on the render thread, followed by swap_gpu_buffer(fps)
+     * @param data frame data, copied
+     * @param fps passed to swap_gpu_buffer()
+     * @return true if submitted, false if the render thread is not running
+     */
+    template<typename T>
+    bool submit_frame(void (*render)(const T& data), const T& data, int fps = forced_fps) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(sizeof(T) <= render_frame_t::data_capacity && alignof(T) <= alignof(std::max_align_t));
+        render_frame_t f;
+        f.invoke = [](const render_frame_t& self) noexcept {
+            reinterpret_cast<void (*)(const T&)>(self.fn)(*std::launder(reinterpret_cast<const T*>(self.data.data())));
+        };
+        f.fn = reinterpret_cast<void (*)()>(render);
+        f.fps = fps;
+        std::memcpy(f.data.data(), &data, sizeof(T));
+        return submit_render_frame(f);
+    }
+
+    /** Background GL upload job, see submit_gl_upload(). */
+    struct gl_upload_t {
+        /** Called on the loader thread with its shared GL context current, e.g. creating and filling buffers or textures. Returns true on success. */
+        bool (*upload)(void* data) noexcept = nullptr;
+        /** Called within poll_gl_uploads() on the rendering thread once the uploaded objects are complete and usable, may be null. */
+        void (*ready)(void* data, bool ok) noexcept = nullptr;
+        /** User data passed to both functions, owned by the caller until ready. */
+        void* data = nullptr;
+    };
+
+    /**
+     * GFX Toolkit: Starts the background GL loader thread using a GL context sharing objects with the primary context.
+     *
+     * Jobs submitted via submit_gl_upload() are executed in order off the rendering thread,
+     * each fenced and reported ready via poll_gl_uploads() once completed on the GPU.
+     * Hence streaming assets does not stall frames.
+     *
+     * Shall be called on the thread the primary GL context is current, before start_render_thread().
+     * Not supported on WebAssembly.
+     *
+     * @return true if started, false on failure, e.g. no shared GL context available
+     */
+    bool start_gl_loader() noexcept;
+    /**
+     * GFX Toolkit: Executes all submitted jobs, stops the loader thread and destroys its GL context.
+     * The ready callbacks of all jobs not yet reported by poll_gl_uploads() are invoked on the calling thread.
+     * Shall be called on the thread calling poll_gl_uploads() while the render thread is not running, i.e. after stop_render_thread().
+     */
+    void stop_gl_loader() noexcept;
+    /** Returns true if the GL loader thread is running, see start_gl_loader(). */
+    bool has_gl_loader() noexcept;
+    /** GFX Toolkit: Submits given job to the GL loader thread, returns false if not running. Thread safe. */
+    bool submit_gl_upload(const gl_upload_t& job) noexcept;
+    /** GFX Toolkit: Invokes the ready callbacks of completed jobs in submission order, to be called once per frame on the rendering thread. Returns their number. */
+    size_t poll_gl_uploads() noexcept;
+
+    /**
+     * Returns frames per seconds, averaged over get_gpu_stat_period().
+     *
+     * The get_gpu_stats_*() getters return a consistent snapshot published by the thread swapping buffers, e.g. the render thread,
+     * and shall be called on one thread only, e.g. the event thread.
+     */
     float get_gpu_stats_fps() noexcept;
     /** Returns rendering costs per frame in seconds, averaged over get_gpu_stat_period(). */
     double get_gpu_stats_frame_costs() noexcept;
     /** Returns active sleeping period per frame in seconds, averaged over get_gpu_stat_period(). Only reasonable if swap_gpu_buffer() has been called with fps > 0. */
     double get_gpu_stats_frame_sleep() noexcept;
+    /**
+     * Returns frame time percentiles of the last completed get_gpu_stats_period().
+     *
+     * Frame time is the duration between two consecutive swap_gpu_buffer() calls.
+     * A frame is over budget if it exceeds 1.5 times the requested frame period, i.e. 1/fps or 1/display_frames_per_sec,
+     * hence has missed at least one display refresh.
+     */
+    duration_percentiles_t get_gpu_stats_frame_percentiles() noexcept;
+    /** Maximum number of most recent frame times kept, see get_gpu_stats_frame_times(). */
+    constexpr size_t gpu_stats_frame_times_capacity = 512;
+    /** Copies the most recent frame times in microseconds into given span, oldest first. Returns the number of copied frame times. */
+    size_t get_gpu_stats_frame_times(std::span<uint32_t> dest) noexcept;
+    /**
+     * Returns true if GPU timer queries are supported by the GL context and measured per frame.
+     *
+     * Requires `GL_EXT_disjoint_timer_query` (ES, WebGL) or `GL_ARB_timer_query`, e.g. not available on WebGL1 w/o extension.
+     */
+    bool has_gpu_timer_query() noexcept;
+    /**
+     * Returns GPU execution time per frame in seconds, averaged over get_gpu_stats_period().
+     *
+     * Measured via timer queries read back a few frames late without stalling, hence excluding CPU submission and vsync blocking.
+     * Returns zero if !has_gpu_timer_query().
+     */
+    double get_gpu_stats_gpu_costs() noexcept;
+    /** Returns GPU execution time percentiles of the last completed get_gpu_stats_period(), over budget if exceeding one frame period. See get_gpu_stats_gpu_costs(). */
+    duration_percentiles_t get_gpu_stats_gpu_percentiles() noexcept;
+    /**
+     * Returns input-to-present latency percentiles of the last completed get_gpu_stats_period().
+     *
+     * Latency is measured from the OS timestamp of the oldest input event handled since the previous frame,
+     * i.e. key or pointer events passed to handle_one_event(), until swap_gpu_buffer() of the frame consuming it has returned.
+     * With the render thread, the frame consuming it is the next one submitted via submit_render_frame().
+     * Frames without input are not counted.
+     * A latency is over budget if it exceeds two frame periods.
+     */
+    duration_percentiles_t get_gpu_stats_input_latency_percentiles() noexcept;
+    /**
+     * Enables or disables the adaptive frame rate governor, disabled by default.
+     *
+     * The governor watches the per-frame CPU and GPU costs and switches between integer divisors
+     * of the base frame rate, i.e. forced fps or display_frames_per_sec, e.g. 60 -> 30 -> 20 -> 15 fps,
+     * avoiding judder caused by frame costs exceeding the refresh budget.
+     *
+     * A slower rate is chosen quickly once the budget is exceeded,
+     * a faster rate only after costs have been well within its budget for about two seconds.
+     *
+     * With vsync and automatic fps, the divisor is applied via the swap interval if supported, otherwise via the frame pacer.
+     */
+    void set_fps_governor(bool enable) noexcept;
+    /** Returns whether the adaptive frame rate governor is enabled, see set_fps_governor(). */
+    bool get_fps_governor() noexcept;
+    /** Returns the current divisor of the base frame rate chosen by the governor, 1 if disabled. See set_fps_governor(). */
+    int get_fps_governor_divisor() noexcept;
+    /** Returns the number of divisor switches since the governor has been enabled. See set_fps_governor(). */
+    uint64_t get_fps_governor_switches() noexcept;
+    /**
+     * Enables or disables dynamic resolution scaling, disabled by default.
+     *
+     * While enabled, the scene rendered between begin_scene() and end_scene() uses an offscreen framebuffer
+     * at get_render_scale() of the viewport size, which end_scene() upscales to the viewport in one pass.
+     * Rendering after end_scene(), e.g. text and UI, remains at native resolution.
+     *
+     * The scale is lowered quickly once the per-frame CPU or GPU costs exceed 90% of the frame budget,
+     * estimating the scale meeting the budget assuming fill rate bound costs,
+     * and raised in small steps after costs have been below 70% for about one second.
+     * Hence sharpness is traded for keeping the frame time within budget.
+     *
+     * The fps governor reacts to the same costs, hence both shall not be enabled at once.
+     * Shall be called on the rendering thread, i.e. before start_render_thread(), and applies to the primary surface only.
+     *
+     * @param enable
+     * @param min_scale lowest render scale [0.25 .. 1]
+     */
+    void set_dynamic_resolution(bool enable, float min_scale = 0.5f) noexcept;
+    /** Returns whether dynamic resolution scaling is enabled, see set_dynamic_resolution(). */
+    bool get_dynamic_resolution() noexcept;
+    /** Returns the current render scale of the scene, 1 if dynamic resolution scaling is disabled. See set_dynamic_resolution(). */
+    float get_render_scale() noexcept;
+    /**
+     * GFX Toolkit: Begins rendering the scene into the scaled offscreen framebuffer, setting the viewport to the scaled size of the current viewport.
+     * No-op if dynamic resolution scaling is disabled. See set_dynamic_resolution().
+     */
+    void begin_scene() noexcept;
+    /**
+     * GFX Toolkit: Ends rendering the scene, upscaling it to the default_framebuffer() and restoring its viewport.
+     * The upscaling pass preserves the GL state, using a framebuffer blit on ES3 or a textured quad otherwise.
+     * No-op if begin_scene() has not been called.
+     */
+    void end_scene() noexcept;
     /** Sets the period length to average get_gpu_fps(), get_gpu_frame_costs(), get_gpu_frame_sleep() statistics. Defaults to 5s.*/
     void set_gpu_stats_period(int64_t milliseconds) noexcept;
     /** Returns the current period length for statistics in milliseconds, see set_gpu_stat_period(). Defaults is 5s. */
     int64_t get_gpu_stats_period() noexcept;
+    /**
+     * Completes the current statistics period immediately, publishing its values to the get_gpu_stats_*() getters and starting a new period.
+     *
+     * Allows measuring a well defined sequence of frames, e.g. a benchmark scene.
+     * While the render thread runs, the period ends with its next presented frame.
+     */
+    void end_gpu_stats_period() noexcept;
     /** Print statistics on the console to stdout after get_gpu_stat_period(). */
     void set_gpu_stats_show(bool enable) noexcept;
     /** Returns whether statistics are printed on the console, see set_show_gpu_stats(). */
@@ -96,7 +403,7 @@ namespace gamp {
         P1_ACTION1,
         P1_ACTION2,
         P1_ACTION3,
-        PAUSE,  // 11
+        PAUSE,  // 12
         P2_UP,
         P2_DOWN,
         P2_RIGHT,
@@ -104,66 +411,209 @@ namespace gamp {
         P2_ACTION1,
         P2_ACTION2,
         P2_ACTION3,
-        RESET,  // 18
+        RESET,  // 20
         /** Request to close window, which then should be closed by caller */
         WINDOW_CLOSE_REQ,
-        WINDOW_RESIZED,  // 20
+        WINDOW_RESIZED,  // 22
+        /** Committed UTF-8 text, see start_text_input(). Beyond the action range, see action_capacity. */
+        TEXT_INPUT = 0x1000,
+        /** UTF-8 text composition of an input method editor (IME), see start_text_input() */
+        TEXT_EDITING,
     };
+    /**
+     * Number of actions tracked by input_event_t, i.e. input_event_type_t values [P1_UP .. P1_UP + action_capacity).
+     *
+     * Values above the predefined enumerators are available for application defined actions, see user_action().
+     */
+    constexpr size_t action_capacity = 256;
+    /** Returns the n-th application defined action, with 0 <= n < action_capacity - bitno(WINDOW_RESIZED) - 1. */
+    constexpr input_event_type_t user_action(int n) noexcept {
+        return static_cast<input_event_type_t>(static_cast<int>(input_event_type_t::WINDOW_RESIZED) + 1 + n);
+    }
     constexpr int bitno(const input_event_type_t e) noexcept {
         return static_cast<int>(e) - static_cast<int>(input_event_type_t::P1_UP);
     }
-    constexpr uint32_t bitmask(const input_event_type_t e) noexcept {
-        return 1U << bitno(e);
+    constexpr bool is_action_bit(const int bit) noexcept {
+        return 0 <= bit && bit < static_cast<int>(action_capacity);
+    }
+    // Values are part of the ABI and of numeric actions in key binding files, see load_key_bindings()
+    static_assert(5 == static_cast<int>(input_event_type_t::P1_UP));
+    static_assert(12 == static_cast<int>(input_event_type_t::PAUSE));
+    static_assert(20 == static_cast<int>(input_event_type_t::RESET));
+    static_assert(22 == static_cast<int>(input_event_type_t::WINDOW_RESIZED));
+    static_assert(!is_action_bit(bitno(input_event_type_t::TEXT_INPUT)) && !is_action_bit(bitno(input_event_type_t::TEXT_EDITING)));
+    // Player actions are contiguous within the lower 64 action bits, see input_event_t::has_any_p1()
+    static_assert(6 == bitno(input_event_type_t::P1_ACTION3) - bitno(input_event_type_t::P1_UP));
+    static_assert(6 == bitno(input_event_type_t::P2_ACTION3) - bitno(input_event_type_t::P2_UP) && bitno(input_event_type_t::P2_ACTION3) < 64);
+
+    /** Set of actions indexed by bitno(), see action_capacity. */
+    typedef std::bitset<action_capacity> action_set_t;
+
+    /** Returns the set holding given action bit, empty if not within the action range, see is_action_bit(). */
+    inline action_set_t bitmask(const int bit) noexcept {
+        action_set_t r;
+        if (is_action_bit(bit)) {
+            r.set(static_cast<size_t>(bit));
+        }
+        return r;
     }
-    constexpr uint32_t bitmask(const int bit) noexcept {
-        return 1U << bit;
+    /** Returns the set holding given action, empty if not an action, see is_action_bit(). */
+    inline action_set_t bitmask(const input_event_type_t e) noexcept {
+        return bitmask(bitno(e));
     }
 
     inline bool is_ascii_code(int c) noexcept {
         return 0 != std::iscntrl(c) || 0 != std::isprint(c);
     }
 
+    /** Fixed capacity text buffer without heap allocation, dropping characters exceeding its capacity N. */
+    template<size_t N>
+    class fixed_text_t {
+        private:
+            std::array<char, N> m_buf;
+            size_t m_len = 0;
+
+        public:
+            constexpr static size_t capacity() noexcept { return N; }
+            size_t length() const noexcept { return m_len; }
+            size_t size() const noexcept { return m_len; }
+            bool empty() const noexcept { return 0 == m_len; }
+            char operator[](size_t i) const noexcept { return m_buf[i]; }
+
+            void clear() noexcept { m_len = 0; }
+            /** Appends c, returns false if full. */
+            bool push_back(char c) noexcept {
+                if (N == m_len) {
+                    return false;
+                }
+                m_buf[m_len++] = c;
+                return true;
+            }
+            void pop_back() noexcept {
+                if (0 < m_len) {
+                    --m_len;
+                }
+            }
+            /** Appends s, truncated to whole UTF-8 sequences if exceeding capacity. Returns false if truncated. */
+            bool append(std::string_view s) noexcept {
+                size_t n = s.size();
+                const bool fits = n <= N - m_len;
+                if (!fits) {
+                    n = N - m_len;
+                    while (0 < n && 0x80 == (static_cast<unsigned char>(s[n]) & 0xC0)) {
+                        --n;  // continuation byte, drop the partial sequence
+                    }
+                }
+                std::copy_n(s.data(), n, m_buf.data() + m_len);
+                m_len += n;
+                return fits;
+            }
+            std::string_view view() const noexcept { return std::string_view(m_buf.data(), m_len); }
+            std::string to_string() const { return std::string(view()); }
+    };
+
+    /**
+     * Compact trivially copyable OS input event, as queued by pump_events() and returned by poll_events().
+     */
+    struct event_t {
+        /** Window of the event, 0 for the primary window, otherwise surface_info_t::window_id. Not recorded, see start_input_recording(). */
+        uint32_t window_id = 0;
+        /** One of POINTER_MOTION, POINTER_BUTTON, ANY_KEY_DOWN, ANY_KEY_UP, TEXT_INPUT, TEXT_EDITING, WINDOW_CLOSE_REQ or WINDOW_RESIZED. */
+        input_event_type_t type = input_event_type_t::NONE;
+        /** Mapped key action of ANY_KEY_DOWN and ANY_KEY_UP, otherwise NONE. */
+        input_event_type_t action = input_event_type_t::NONE;
+        /** ASCII code of ANY_KEY_DOWN and ANY_KEY_UP, otherwise 0. */
+        uint16_t key_code = 0;
+        /** Pointer type of POINTER_MOTION and POINTER_BUTTON. */
+        pointer_type_t pointer_type = pointer_type_t::mouse;
+        /** Button of POINTER_BUTTON, 1 is the primary button or touch contact. */
+        uint8_t button = 0;
+        /** Pressed state of POINTER_BUTTON. */
+        bool down = false;
+        /** Pointer id of POINTER_MOTION and POINTER_BUTTON. */
+        int32_t id = 0;
+        /**
+         * Pointer position of POINTER_MOTION and POINTER_BUTTON in window units, window size of WINDOW_RESIZED,
+         * cursor position and selection length in UTF-8 characters of TEXT_EDITING.
+         */
+        int32_t x = 0;
+        int32_t y = 0;
+        /** Relative motion of POINTER_MOTION in window units, accumulated if coalesced, see set_motion_coalescing(). */
+        int32_t dx = 0;
+        int32_t dy = 0;
+        /** Normalized pressure [0..1] of POINTER_MOTION and POINTER_BUTTON. */
+        float pressure = 0.0f;
+        /** Monotonic time as reported by the OS, see jau::getMonotonicTime(). */
+        jau::fraction_timespec timestamp;
+        /** Zero terminated UTF-8 text of TEXT_INPUT and TEXT_EDITING. */
+        std::array<char, 32> text = {};
+
+        std::string_view text_view() const noexcept { return std::string_view(text.data()); }
+    };
+    static_assert(std::is_trivially_copyable_v<event_t>);
+
     class input_event_t {
         private:
-            constexpr static const uint32_t p1_mask =
-                bitmask(input_event_type_t::P1_UP) |
-                bitmask(input_event_type_t::P1_DOWN) |
-                bitmask(input_event_type_t::P1_RIGHT) |
-                bitmask(input_event_type_t::P1_LEFT) |
-                bitmask(input_event_type_t::P1_ACTION1) |
-                bitmask(input_event_type_t::P1_ACTION2) |
-                bitmask(input_event_type_t::P1_ACTION3);
-
-            constexpr static const uint32_t p2_mask =
-                bitmask(input_event_type_t::P2_UP) |
-                bitmask(input_event_type_t::P2_DOWN) |
-                bitmask(input_event_type_t::P2_RIGHT) |
-                bitmask(input_event_type_t::P2_LEFT) |
-                bitmask(input_event_type_t::P2_ACTION1) |
-                bitmask(input_event_type_t::P2_ACTION2) |
-                bitmask(input_event_type_t::P2_ACTION3);
-            uint32_t m_pressed;  // [P1_UP..RESET]
-            uint32_t m_lifted;   // [P1_UP..RESET]
+            constexpr static const action_set_t p1_mask = action_set_t(0x7FULL << bitno(input_event_type_t::P1_UP));  // P1_UP .. P1_ACTION3
+            constexpr static const action_set_t p2_mask = action_set_t(0x7FULL << bitno(input_event_type_t::P2_UP));  // P2_UP .. P2_ACTION3
+            action_set_t m_pressed;  // [P1_UP..P1_UP+action_capacity)
+            action_set_t m_lifted;   // [P1_UP..P1_UP+action_capacity)
+            action_set_t m_pressed_frame;  // pressed since begin_frame()
             bool m_paused;
 
         public:
             input_event_type_t last;
             /** ASCII code, ANY_KEY_UP, ANY_KEY_DOWN key code */
             uint16_t last_key_code;
-            std::string text;
+            /** UTF-8 text committed in this frame, cleared by begin_frame(). Only received while text input is active, see start_text_input(). */
+            fixed_text_t<256> text;
+            /** Pending UTF-8 text composition of an input method editor, empty if none. */
+            fixed_text_t<64> composition;
+            /** Cursor position and selection length within composition in UTF-8 characters. */
+            int composition_cursor;
+            int composition_selection;
             int pointer_id;
             int pointer_x;
             int pointer_y;
+            /** Per pointer state of mouse and touch contacts including gestures, pointer_id, pointer_x and pointer_y reflect the last moved pointer. */
+            pointer_state_t pointers;
+            /** Monotonic time of the last key or pointer event as reported by the OS, see jau::getMonotonicTime(). */
+            jau::fraction_timespec timestamp;
 
             input_event_t() noexcept { clear(); }
             void clear() noexcept {
-                m_pressed = 0;
-                m_lifted = 0;
+                m_pressed.reset();
+                m_lifted.reset();
+                m_pressed_frame.reset();
                 m_paused = false;
                 last = input_event_type_t::NONE;
                 pointer_id = -1;
                 pointer_x = -1;
                 pointer_y = -1;
+                pointers.clear();
+                text.clear();
+                composition.clear();
+                composition_cursor = 0;
+                composition_selection = 0;
+            }
+            /** Resets per frame state, i.e. the committed text, actions pressed in this frame and pointer deltas, called before applying the events of a new frame. */
+            void begin_frame() noexcept {
+                text.clear();
+                m_pressed_frame.reset();
+                pointers.begin_frame();
+            }
+            /**
+             * Merges the per frame state of given older snapshot not consumed into this newer one,
+             * i.e. prepends its text and accumulates pressed actions, released actions and pointer deltas. See input_snapshot().
+             * Released actions pressed again meanwhile are dropped, i.e. only released actions still lifted are merged.
+             */
+            void merge_previous(const input_event_t& older) noexcept {
+                fixed_text_t<256> t = older.text;
+                t.append(text.view());
+                text = t;
+                m_pressed_frame |= older.m_pressed_frame;
+                m_lifted = (m_lifted | older.m_lifted) & ~m_pressed;
+                pointers.merge_previous(older.pointers);
             }
             void pointer_motion(int id, int x, int y) noexcept {
                 set(input_event_type_t::POINTER_MOTION);
@@ -173,33 +623,64 @@ namespace gamp {
             }
             void set(input_event_type_t e, uint16_t key_code = 0) noexcept {
                 const int bit = bitno(e);
-                if (0 <= bit && bit <= 31) {
-                    const uint32_t m = bitmask(bit);
-                    m_lifted &= ~m;
-                    m_pressed |= m;
+                if (is_action_bit(bit)) {
+                    m_lifted.reset(bit);
+                    m_pressed.set(bit);
+                    m_pressed_frame.set(bit);
                 }
                 this->last = e;
                 this->last_key_code = key_code;
-                if (this->text.length() > 0 && '\n' == this->text[this->text.length() - 1]) {
-                    this->text.clear();
-                }
-                if (0 != key_code && is_ascii_code(key_code)) {
-                    if (0x08 == key_code) {
-                        if (this->text.length() > 0) {
-                            this->text.pop_back();
+            }
+            /** Applies given OS event, see poll_events(). */
+            void apply(const event_t& e) noexcept {
+                switch (e.type) {
+                    case input_event_type_t::WINDOW_CLOSE_REQ:
+                        [[fallthrough]];
+                    case input_event_type_t::WINDOW_RESIZED:
+                        if (0 == e.window_id) {  // additional surfaces track their own state, see surface_info_t
+                            set(e.type);
                         }
-                    } else {
-                        this->text.push_back((char)key_code);
-                    }
+                        break;
+                    case input_event_type_t::POINTER_MOTION:
+                        pointer_motion(e.id, e.x, e.y);
+                        pointers.motion(e.pointer_type, e.id, e.x, e.y, e.dx, e.dy, e.pressure, e.timestamp);
+                        timestamp = e.timestamp;
+                        break;
+                    case input_event_type_t::POINTER_BUTTON:
+                        set(input_event_type_t::POINTER_BUTTON);
+                        pointers.button(e.pointer_type, e.id, e.button, e.down, e.x, e.y, e.pressure, e.timestamp);
+                        timestamp = e.timestamp;
+                        break;
+                    case input_event_type_t::ANY_KEY_UP:
+                        clear(e.action, e.key_code);
+                        timestamp = e.timestamp;
+                        break;
+                    case input_event_type_t::ANY_KEY_DOWN:
+                        set(e.action, e.key_code);
+                        timestamp = e.timestamp;
+                        break;
+                    case input_event_type_t::TEXT_INPUT:
+                        text.append(e.text_view());
+                        composition.clear();
+                        timestamp = e.timestamp;
+                        break;
+                    case input_event_type_t::TEXT_EDITING:
+                        composition.clear();
+                        composition.append(e.text_view());
+                        composition_cursor = e.x;
+                        composition_selection = e.y;
+                        break;
+                    default: break;
                 }
             }
             void clear(input_event_type_t e, uint16_t key_code = 0) noexcept {
                 (void)key_code;
                 const int bit = bitno(e);
-                if (0 <= bit && bit <= 31) {
-                    const uint32_t m = bitmask(bit);
-                    m_lifted |= m_pressed & m;
-                    m_pressed &= ~m;
+                if (is_action_bit(bit)) {
+                    if (m_pressed.test(bit)) {
+                        m_lifted.set(bit);
+                    }
+                    m_pressed.reset(bit);
                     this->last_key_code = 0;
                 }
                 if (input_event_type_t::PAUSE == e) {
@@ -209,11 +690,12 @@ namespace gamp {
             bool paused() const noexcept { return m_paused; }
             bool pressed(input_event_type_t e) const noexcept {
                 const int bit = bitno(e);
-                if (0 <= bit && bit <= 31) {
-                    return 0 != (m_pressed & bitmask(bit));
-                } else {
-                    return false;
-                }
+                return is_action_bit(bit) && m_pressed.test(bit);
+            }
+            /** Returns true if given action has been pressed since begin_frame(), even if released meanwhile. */
+            bool pressed_in_frame(input_event_type_t e) const noexcept {
+                const int bit = bitno(e);
+                return is_action_bit(bit) && m_pressed_frame.test(bit);
             }
             bool pressed_and_clr(input_event_type_t e) noexcept {
                 if (pressed(e)) {
@@ -225,44 +707,259 @@ namespace gamp {
             }
             bool released_and_clr(input_event_type_t e) noexcept {
                 const int bit = bitno(e);
-                if (0 <= bit && bit <= 31) {
-                    const uint32_t m = bitmask(bit);
-                    if (0 != (m_lifted & m)) {
-                        m_lifted &= ~m;
-                        return true;
-                    }
+                if (is_action_bit(bit) && m_lifted.test(bit)) {
+                    m_lifted.reset(bit);
+                    return true;
                 }
                 return false;
             }
             bool has_any_p1() const noexcept {
-                return 0 != ((m_pressed | m_lifted) & p1_mask);
+                return ((m_pressed | m_lifted) & p1_mask).any();
             }
             bool has_any_p2() const noexcept {
-                return 0 != ((m_pressed | m_lifted) & p2_mask);
+                return ((m_pressed | m_lifted) & p2_mask).any();
             }
             std::string to_string() const noexcept;
     };
     inline std::string to_string(const input_event_t& e) noexcept { return e.to_string(); }
 
+    /**
+     * GFX Toolkit: Initializes the optional game controller subsystem, opening connected controllers and enabling hotplug.
+     *
+     * Per-axis and per-button controller events are disabled, controller state is polled once per frame via poll_controllers() instead.
+     * Shall be called after init_gfx_subsystem() on the same thread.
+     *
+     * @return false if not supported
+     */
+    bool init_controller_subsystem() noexcept;
+    /**
+     * GFX Toolkit: Sets the deadzones of analog sticks, radial, and triggers as fraction of their range. Defaults to 0.15 and 0.05.
+     */
+    void set_controller_deadzone(float stick, float trigger) noexcept;
+    /**
+     * GFX Toolkit: Polls all game controllers in one batch and returns the deadzone filtered snapshot of this frame.
+     *
+     * Connects or disconnects controllers as hotplugged.
+     * Button and left stick changes of controller slot 0 and 1 are applied to the player 1 and 2 actions of given event,
+     * i.e. the d-pad or left stick to P1_UP .. P1_LEFT, the A, B and X buttons to P1_ACTION1 .. P1_ACTION3,
+     * as well as start to PAUSE and back to RESET.
+     *
+     * Returns an empty snapshot if init_controller_subsystem() has not been called.
+     */
+    const controller_snapshot_t& poll_controllers(input_event_t& event) noexcept;
+
+    /** Input replay mode, see start_input_replay(). */
+    enum class replay_mode_t : uint8_t {
+        /** Replays events at their recorded time relative to the replay start. */
+        realtime,
+        /** Replays the events of one recorded frame per frame, as fast as frames are rendered. */
+        fast
+    };
+    /**
+     * Starts recording all events returned by poll_events() into given compact binary file,
+     * including their monotonic time relative to the recording start and frame markers per swap_gpu_buffer().
+     *
+     * @return false on I/O error
+     */
+    bool start_input_recording(const std::string& path) noexcept;
+    /** Stops and closes an active recording, see start_input_recording(). */
+    void stop_input_recording() noexcept;
+    /**
+     * Starts replaying a recording of start_input_recording(), replacing live input of poll_events() and hence handle_one_event().
+     *
+     * Live window close requests and resizes are still passed, recorded window resizes are skipped.
+     * Replayed events are stamped with their monotonic replay time.
+     * Live input resumes once the replay has ended.
+     *
+     * @return false on I/O error or if the file is not a recording
+     */
+    bool start_input_replay(const std::string& path, replay_mode_t mode) noexcept;
+    /** Stops an active replay, see start_input_replay(). */
+    void stop_input_replay() noexcept;
+    /** Returns true while a replay is active, false once it has ended. */
+    bool is_input_replaying() noexcept;
+
+    /** Number of keyboard scancodes, i.e. valid scancodes are [0 .. scancode_count). */
+    constexpr size_t scancode_count = 512;
+
+    /**
+     * GFX Toolkit: Binds given keyboard scancode to given action, e.g. input_event_type_t::P1_UP or a user_action().
+     *
+     * Passing input_event_type_t::NONE unbinds the scancode.
+     * Bindings are looked up by table per key event, hence shall only be changed on the thread polling events,
+     * see pump_events() and poll_events().
+     *
+     * @return false if scancode is out of range
+     */
+    bool bind_key(int scancode, input_event_type_t action) noexcept;
+    /** GFX Toolkit: Returns the action bound to given scancode, or input_event_type_t::NONE if unbound or out of range. */
+    input_event_type_t get_key_binding(int scancode) noexcept;
+    /** GFX Toolkit: Restores the default key bindings, e.g. cursor keys for player 1 and WASD for player 2. */
+    void reset_key_bindings() noexcept;
+    /**
+     * GFX Toolkit: Loads key bindings from given config file, applying them on top of the current bindings.
+     *
+     * Each line binds one key as `<scancode> = <action>`, `#` starts a comment.
+     * The scancode is given by its toolkit name, e.g. `Left` or `W`, or by number.
+     * The action is given by its input_event_type_t name, e.g. `P1_LEFT`, `NONE` to unbind, or by number for user_action().
+     *
+     * @return false on I/O error or if a line could not be parsed, which is skipped
+     */
+    bool load_key_bindings(const std::string& path) noexcept;
+
     /**
      * GFX Toolkit: Handle windowing and keyboard events.
      *
      * Should be called until function returns false
      * to process all buffered events.
      *
+     * The first call after returning false starts a new frame, resetting per frame state via input_event_t::begin_frame(),
+     * e.g. input_event_t::text.
+     *
      * @param event
      * @return true if event received, false otherwise
      */
     bool handle_one_event(input_event_t& event) noexcept;
 
+    /**
+     * GFX Toolkit: Fills given caller provided array with pending OS events without heap allocation.
+     *
+     * Window resize and close requests are handled by the toolkit as with handle_one_event(),
+     * applying the returned events to an input_event_t is left to the caller, see input_event_t::apply().
+     * In event pump mode, events are taken from the event queue, see set_event_pump().
+     *
+     * @param events destination array
+     * @return number of events stored, zero if none are pending
+     */
+    size_t poll_events(std::span<event_t> events) noexcept;
+
+    /** Capacity of the event pump queue, see set_event_pump(). */
+    constexpr size_t event_queue_capacity = 1024;
+
+    /**
+     * GFX Toolkit: Enables or disables the event pump mode, disabled by default.
+     *
+     * In event pump mode, OS events are polled by pump_events() on the producer thread,
+     * converted to compact event_t and pushed into a bounded lock-free single producer, single consumer queue.
+     * handle_events() on the render thread drains the queue in one batch via drain_events() instead of polling the OS,
+     * hence a long frame no longer delays event polling and an event burst no longer delays rendering.
+     *
+     * Polling OS events is restricted to the thread which initialized the gfx subsystem,
+     * i.e. the producer is the main thread once rendering runs on its own thread.
+     * Without such thread, call pump_events() before handle_events() each frame.
+     *
+     * Shall be set before the producer is started.
+     */
+    void set_event_pump(bool enable) noexcept;
+    /** Returns whether the event pump mode is enabled, see set_event_pump(). */
+    bool get_event_pump() noexcept;
+    /**
+     * GFX Toolkit: Producer of event pump mode, polls all pending OS events into the event queue.
+     *
+     * @param timeout_ms if > 0, waits up to given milliseconds for the first event, allowing a producer thread to block
+     * @return number of queued events
+     */
+    size_t pump_events(int timeout_ms = 0) noexcept;
+    /**
+     * GFX Toolkit: Drains all pending events in batches via poll_events() and applies them to given event,
+     * i.e. the consumer in event pump mode. Publishes the resulting event to input_snapshot() if enabled.
+     * @return number of drained events
+     */
+    size_t drain_events(input_event_t& event) noexcept;
+    /**
+     * Returns the number of events dropped by pump_events() due to a full queue.
+     * Pointer motion is dropped at 3/4 of event_queue_capacity and other input at 15/16, keeping room for window events.
+     */
+    uint64_t get_event_pump_dropped() noexcept;
+
+    /**
+     * GFX Toolkit: Enables or disables per frame pointer motion coalescing of drain_events(), disabled by default.
+     *
+     * If enabled, all motion events of one pointer are folded into one motion per frame at its last position
+     * with accumulated event_t::dx and event_t::dy, flushed before a button event of the same pointer to preserve order.
+     * This saves applying each event of high rate mice, while the intermediate positions
+     * can be preserved via the sample history, see pointer_state_t::set_sample_history().
+     *
+     * poll_events() and handle_one_event() still deliver each event.
+     */
+    void set_motion_coalescing(bool enable) noexcept;
+    /** Returns whether per frame pointer motion coalescing is enabled, see set_motion_coalescing(). */
+    bool get_motion_coalescing() noexcept;
+
+    /**
+     * GFX Toolkit: Enables or disables relative mouse mode, i.e. hides and confines the mouse cursor to the window.
+     *
+     * In relative mouse mode only event_t::dx and event_t::dy resp. pointer_t::dx and pointer_t::dy are meaningful.
+     * @return true if successful, false if not supported
+     */
+    bool set_relative_mouse_mode(bool enable) noexcept;
+    /** Returns whether relative mouse mode is enabled, see set_relative_mouse_mode(). */
+    bool get_relative_mouse_mode() noexcept;
+
+    /**
+     * GFX Toolkit: Starts UTF-8 text input, e.g. when a text field gains focus. Text input is inactive by default.
+     *
+     * While active, committed text is delivered as TEXT_INPUT into input_event_t::text per frame
+     * and input method editor (IME) compositions as TEXT_EDITING into input_event_t::composition.
+     * Key events are still delivered, on-screen keyboards may be shown.
+     */
+    void start_text_input() noexcept;
+    /** GFX Toolkit: Stops UTF-8 text input, e.g. when a text field loses focus, see start_text_input(). */
+    void stop_text_input() noexcept;
+    /** Returns whether UTF-8 text input is active, see start_text_input(). */
+    bool is_text_input_active() noexcept;
+    /** GFX Toolkit: Sets the focused text field's rectangle in window units, used to place the IME candidate window. */
+    void set_text_input_rect(const jau::math::Recti& r) noexcept;
+
+    /**
+     * GFX Toolkit: Handle all pending windowing and keyboard events in batches, see drain_events().
+     *
+     * @param event
+     * @return true if at least one event has been received, false otherwise
+     */
     inline bool handle_events(input_event_t& event) noexcept {
-        bool one = false;
-        while (gamp::handle_one_event(event)) {
-            one = true;
-            // std::cout << "Input " << to_string(event) << std::endl;
-        }
-        return one;
+        GAMP_PROFILE_ZONE("handle_events");
+        GAMP_PROFILE_FRAME_MARK("events");
+        return 0 < drain_events(event);
     }
+
+    /**
+     * GFX Toolkit: Late-latches the most recent pointer position into given event, i.e. input_event_t::pointer_x and pointer_y.
+     *
+     * Intended to be called right before the final draw submission of a frame, after handle_events() at its start,
+     * allowing to patch pointer dependent state like the view matrix uniform with the freshest pointer position.
+     * This reduces perceived latency of drag interactions by up to one frame without blocking.
+     *
+     * The newest queued pointer motion of the primary window is latched, scanning the whole queue.
+     * Only the position is latched and no events are consumed, i.e. all events including button presses are applied in order by the next handle_events().
+     * In event pump mode, the most recent pointer position seen by pump_events() is latched, see set_event_pump().
+     * Since all events are applied by handle_events(), an input recording contains all pointer motion.
+     * No-op while replaying an input recording, see start_input_replay().
+     *
+     * @param event
+     * @return true if pointer motion has been latched, false if the pointer has not moved
+     */
+    bool latch_pointer_motion(input_event_t& event) noexcept;
+
+    /** Triple buffered immutable per frame snapshot of input_event_t, see input_snapshot(). */
+    typedef triple_buffer_t<input_event_t> input_snapshot_t;
+
+    /**
+     * Returns the input snapshot shared between the event thread and a separate simulation thread.
+     *
+     * If enabled via set_input_snapshot_publish(), drain_events() publishes its input_event_t once per frame,
+     * the simulation thread acquires the latest consistent state via input_snapshot_t::update() and input_snapshot_t::front()
+     * without locks or waiting on either side.
+     *
+     * Level state like pressed actions and pointer positions is always current.
+     * Per frame state of frames the simulation thread skipped is merged into the next snapshot via input_event_t::merge_previous(),
+     * i.e. input_event_t::text, input_event_t::pressed_in_frame(), released actions and pointer deltas accumulate until acquired.
+     */
+    input_snapshot_t& input_snapshot() noexcept;
+    /** Enables or disables publishing input_snapshot() by drain_events(), disabled by default. */
+    void set_input_snapshot_publish(bool enable) noexcept;
+    /** Returns whether drain_events() publishes input_snapshot(), see set_input_snapshot_publish(). */
+    bool get_input_snapshot_publish() noexcept;
 }  // namespace gamp
 
 #endif /*  JAU_GAMP_HPP_ */
@@ -24,14 +24,22 @@
 #ifndef JAU_GAMP_TYPES_HPP_
 #define JAU_GAMP_TYPES_HPP_
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <cinttypes>
 #include <cmath>
 #include <cstdarg>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <span>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
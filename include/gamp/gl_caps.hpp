@@ -0,0 +1,104 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_GL_CAPS_HPP_
+#define JAU_GAMP_GL_CAPS_HPP_
+
+#include <cstdint>
+#include <string>
+
+namespace gamp {
+
+    /** GL extensions tracked by gl_caps_t::extensions, see gl_ext_name(). */
+    enum class gl_ext_t : uint8_t {
+        ANGLE_instanced_arrays,
+        APPLE_sync,
+        ARB_timer_query,
+        EXT_color_buffer_float,
+        EXT_color_buffer_half_float,
+        EXT_disjoint_timer_query,
+        EXT_disjoint_timer_query_webgl2,
+        EXT_instanced_arrays,
+        EXT_texture_filter_anisotropic,
+        KHR_debug,
+        NV_framebuffer_blit,
+        OES_depth24,
+        OES_element_index_uint,
+        OES_get_program_binary,
+        OES_packed_depth_stencil,
+        OES_rgb8_rgba8,
+        OES_standard_derivatives,
+        OES_texture_float,
+        OES_texture_float_linear,
+        OES_texture_half_float,
+        OES_texture_npot,
+        OES_vertex_array_object,
+        count_
+    };
+    static_assert(static_cast<unsigned>(gl_ext_t::count_) <= 64);
+
+    /** Returns the GL extension name of given enum, e.g. `GL_OES_depth24`. */
+    const char* gl_ext_name(gl_ext_t ext) noexcept;
+
+    /** GL capabilities of the primary context, probed once after its creation. See gl_caps. */
+    struct gl_caps_t {
+        /** Bitset of supported gl_ext_t, see has(). */
+        uint64_t extensions = 0;
+        /** True for ES3 or WebGL2, otherwise ES2 or WebGL1. */
+        bool es3 = false;
+        int max_texture_size = 0;
+        int max_renderbuffer_size = 0;
+        int max_texture_image_units = 0;
+        int max_vertex_attribs = 0;
+        int max_vertex_uniform_vectors = 0;
+        int max_fragment_uniform_vectors = 0;
+        /** Instanced drawing, ES3 or ANGLE_instanced_arrays or EXT_instanced_arrays. */
+        bool instancing = false;
+        /** Vertex array objects, ES3 or OES_vertex_array_object. */
+        bool vertex_array_object = false;
+        /** GPU timer queries, EXT_disjoint_timer_query or ARB_timer_query. */
+        bool timer_query = false;
+        /** Sampling float textures, ES3 or OES_texture_float. */
+        bool float_texture = false;
+        /** Rendering into float color buffers, EXT_color_buffer_float or EXT_color_buffer_half_float. */
+        bool float_render_target = false;
+        /** Scaling framebuffer blit, ES3 or NV_framebuffer_blit. */
+        bool framebuffer_blit = false;
+        /** Fence sync objects, ES3 or APPLE_sync. */
+        bool fence_sync = false;
+        /** Number of program binary formats, ES3 or OES_get_program_binary, zero if none. */
+        int program_binary_formats = 0;
+
+        /** Returns true if given extension is supported. */
+        constexpr bool has(gl_ext_t ext) const noexcept {
+            return 0 != (extensions & (uint64_t(1) << static_cast<unsigned>(ext)));
+        }
+        std::string toString() const noexcept;
+    };
+
+    /** GL capabilities of the primary context, probed once after its creation by init_gfx_subsystem() or init_gfx_subsystem_headless(). */
+    extern gl_caps_t gl_caps;
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_GL_CAPS_HPP_ */
@@ -0,0 +1,52 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_LOG_HPP_
+#define JAU_GAMP_LOG_HPP_
+
+#include <cstdint>
+
+namespace gamp {
+
+    /** Log level of log_printf(), ordered by increasing verbosity. */
+    enum class log_level_t : uint8_t {
+        none,
+        error,
+        warn,
+        info,
+        debug,
+        trace
+    };
+
+    /** Sets the maximum log level printed by log_printf(), defaults to info. */
+    void set_log_level(log_level_t level) noexcept;
+    log_level_t get_log_level() noexcept;
+    /** Returns true if given level is printed, allowing to skip preparing costly arguments. */
+    bool is_log_enabled(log_level_t level) noexcept;
+
+    /** Prints the printf formatted message to stdout if given level is enabled, see set_log_level(). */
+    void log_printf(log_level_t level, const char* format, ...) noexcept __attribute__((format(printf, 2, 3)));
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_LOG_HPP_ */
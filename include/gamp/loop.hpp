@@ -0,0 +1,152 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_LOOP_HPP_
+#define JAU_GAMP_LOOP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include <jau/basic_types.hpp>
+#include <jau/fraction_type.hpp>
+
+namespace gamp {
+
+    /**
+     * Fixed timestep simulation loop driver with render interpolation.
+     *
+     * Each frame() call accumulates the elapsed monotonic time since its previous call
+     * and advances the simulation by whole fixed steps, independent of the frame rate.
+     * The remaining time below one step is passed to the render callback as interpolation alpha [0..1)
+     * between the previous and the current simulation state.
+     *
+     * frame() shall be called once per rendered frame, which works the same
+     * from a native `while(true)` loop and an `emscripten_set_main_loop()` callback.
+     *
+     * Steps per frame are limited to max_steps(), dropping further accumulated time.
+     * Under load the simulation hence slows down instead of spiraling into ever more steps per frame.
+     */
+    class fixed_step_loop_t {
+        private:
+            int64_t m_step_ns;
+            int m_max_steps;
+            int64_t m_acc_ns = 0;
+            int64_t m_last_ns = 0;
+            bool m_started = false;
+            bool m_paused = false;
+            float m_alpha = 0.0f;
+            uint64_t m_steps = 0;
+            uint64_t m_clamped_frames = 0;
+
+            static int64_t to_ns(const jau::fraction_timespec& t) noexcept {
+                return t.tv_sec * 1000000000 + t.tv_nsec;
+            }
+
+        public:
+            /**
+             * Constructs a loop with given fixed simulation step duration
+             * and maximum number of simulation steps per frame.
+             */
+            explicit fixed_step_loop_t(const jau::fraction_timespec& step, int max_steps = 5) noexcept
+            : m_step_ns(std::max<int64_t>(1, to_ns(step))), m_max_steps(std::max(1, max_steps)) {}
+
+            /** Returns the fixed simulation step duration. */
+            jau::fraction_timespec step() const noexcept { return jau::fraction_timespec(m_step_ns / 1000000000, m_step_ns % 1000000000); }
+            /** Returns the fixed simulation step duration in seconds, as passed to the update callback. */
+            float step_sec() const noexcept { return static_cast<float>(static_cast<double>(m_step_ns) / 1.0e9); }
+            /** Returns the maximum number of simulation steps per frame. */
+            int max_steps() const noexcept { return m_max_steps; }
+            /** Returns the total number of simulation steps, i.e. the current simulation tick. */
+            uint64_t steps() const noexcept { return m_steps; }
+            /** Returns the number of frames limited to max_steps(), i.e. where accumulated time has been dropped. */
+            uint64_t clamped_frames() const noexcept { return m_clamped_frames; }
+            /** Returns the interpolation alpha [0..1) of the last frame(). */
+            float alpha() const noexcept { return m_alpha; }
+
+            /**
+             * Pauses or resumes the simulation.
+             *
+             * While paused, frame() performs no simulation steps and keeps the last alpha().
+             * Time passed while paused is not caught up after resuming.
+             */
+            void set_paused(bool v) noexcept {
+                if (m_paused && !v) {
+                    m_started = false;
+                }
+                m_paused = v;
+            }
+            bool paused() const noexcept { return m_paused; }
+
+            /** Drops accumulated time and restarts time measurement with the next frame(), keeping steps(). */
+            void reset() noexcept {
+                m_acc_ns = 0;
+                m_started = false;
+                m_alpha = 0.0f;
+            }
+
+            /**
+             * Advances the simulation using given monotonic time, e.g. for deterministic replay, and renders the frame.
+             *
+             * @param now monotonic time of this frame
+             * @param update simulation callback `void(float dt_sec)`, called zero or more times with step_sec()
+             * @param render render callback `void(float alpha)`, called once with the interpolation alpha
+             * @return number of simulation steps performed
+             */
+            template<typename Update, typename Render>
+            int frame(const jau::fraction_timespec& now, Update&& update, Render&& render) {
+                const int64_t now_ns = to_ns(now);
+                int n = 0;
+                if (!m_paused) {
+                    if (m_started) {
+                        m_acc_ns += std::max<int64_t>(0, now_ns - m_last_ns);
+                    }
+                    m_started = true;
+                    const float dt = step_sec();
+                    while (m_acc_ns >= m_step_ns && n < m_max_steps) {
+                        update(dt);
+                        m_acc_ns -= m_step_ns;
+                        ++m_steps;
+                        ++n;
+                    }
+                    if (m_acc_ns >= m_step_ns) {
+                        m_acc_ns %= m_step_ns;
+                        ++m_clamped_frames;
+                    }
+                    m_alpha = static_cast<float>(static_cast<double>(m_acc_ns) / static_cast<double>(m_step_ns));
+                }
+                m_last_ns = now_ns;
+                render(m_alpha);
+                return n;
+            }
+
+            /** Advances the simulation using the current monotonic time and renders the frame, see frame(const jau::fraction_timespec&, Update&&, Render&&). */
+            template<typename Update, typename Render>
+            int frame(Update&& update, Render&& render) {
+                return frame(jau::getMonotonicTime(), std::forward<Update>(update), std::forward<Render>(render));
+            }
+    };
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_LOOP_HPP_ */
@@ -0,0 +1,348 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_POINTER_HPP_
+#define JAU_GAMP_POINTER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include <jau/basic_types.hpp>
+#include <jau/fraction_type.hpp>
+
+namespace gamp {
+
+    /** Pointer device type. */
+    enum class pointer_type_t : uint8_t {
+        mouse,
+        touch
+    };
+
+    /** State of one pointer, i.e. the mouse or one touch contact. Coordinates are in window units. */
+    struct pointer_t {
+        /** True if this slot is in use. */
+        bool active = false;
+        pointer_type_t type = pointer_type_t::mouse;
+        /** Device specific pointer id, e.g. mouse instance or finger id. */
+        int id = -1;
+        int x = 0;
+        int y = 0;
+        /** Movement since the previous frame, see pointer_state_t::begin_frame(). */
+        int dx = 0;
+        int dy = 0;
+        /** Position at the last button press. */
+        int down_x = 0;
+        int down_y = 0;
+        /** Pressed buttons, bit `n-1` for button `n`, i.e. bit 0 is the primary button or touch contact. */
+        uint32_t buttons = 0;
+        /** Normalized pressure [0..1], 1 for pressed mouse buttons. */
+        float pressure = 0.0f;
+        /** Monotonic time of the last button press. */
+        jau::fraction_timespec t_down;
+        /** Monotonic time of the last event. */
+        jau::fraction_timespec t_last;
+
+        bool pressed() const noexcept { return 0 != buttons; }
+    };
+
+    /**
+     * Compact pointer motion sample of the optional per frame sample history, see pointer_state_t::set_sample_history().
+     *
+     * Preserves the intermediate positions of motion coalesced per frame, e.g. for ink and drawing.
+     */
+    struct pointer_sample_t {
+        /** Pointer slot, see pointer_state_t::operator[](). */
+        uint8_t slot = 0;
+        /** Normalized pressure [0..1] scaled to [0..255]. */
+        uint8_t pressure = 0;
+        /** Position in window units. */
+        int16_t x = 0;
+        int16_t y = 0;
+        /** Microseconds since the first sample of this frame. */
+        uint16_t t_us = 0;
+
+        float pressure_f() const noexcept { return static_cast<float>(pressure) / 255.0f; }
+    };
+    static_assert(8 == sizeof(pointer_sample_t));
+
+    /**
+     * Incrementally tracked gestures of pressed pointers.
+     *
+     * A drag is a single pressed pointer, a pinch the first two pressed pointers.
+     * Per frame values are reset by pointer_state_t::begin_frame().
+     */
+    struct gesture_t {
+        /** Number of pressed pointers. */
+        int contacts = 0;
+        bool dragging = false;
+        /** Drag movement in window units of this frame. */
+        int drag_dx = 0;
+        int drag_dy = 0;
+        bool pinching = false;
+        /** Pinch distance ratio of this frame, 1 if unchanged. */
+        float pinch_scale_delta = 1.0f;
+        /** Pinch distance ratio since the pinch started. */
+        float pinch_scale = 1.0f;
+        /** Pinch center in window units. */
+        float pinch_x = 0.0f;
+        float pinch_y = 0.0f;
+    };
+
+    /**
+     * Fixed capacity multi-pointer state for mouse and touch input, without heap allocation.
+     *
+     * Touch contacts occupy a slot from press until begin_frame() after their release,
+     * the mouse keeps its slot once seen. Further pointers exceeding capacity are ignored.
+     */
+    class pointer_state_t {
+        public:
+            constexpr static size_t capacity = 10;
+            /** Maximum number of samples per frame, further samples are dropped. */
+            constexpr static size_t sample_capacity = 512;
+
+        private:
+            std::array<pointer_t, capacity> m_pointers;
+            std::array<pointer_sample_t, sample_capacity> m_samples;
+            size_t m_sample_count = 0;
+            bool m_sample_history = false;
+            jau::fraction_timespec m_sample_t0;
+            gesture_t m_gesture;
+            int m_pinch_a = -1;
+            int m_pinch_b = -1;
+            float m_pinch_dist0 = 0.0f;
+            float m_pinch_dist_last = 0.0f;
+
+            pointer_t* find(pointer_type_t type, int id, bool create) noexcept {
+                pointer_t* free_slot = nullptr;
+                for (pointer_t& p : m_pointers) {
+                    if (p.active) {
+                        if (p.type == type && p.id == id) {
+                            return &p;
+                        }
+                    } else if (nullptr == free_slot) {
+                        free_slot = &p;
+                    }
+                }
+                if (create && nullptr != free_slot) {
+                    *free_slot = pointer_t();
+                    free_slot->active = true;
+                    free_slot->type = type;
+                    free_slot->id = id;
+                }
+                return create ? free_slot : nullptr;
+            }
+
+            void update_gesture() noexcept {
+                int a = -1, b = -1, n = 0;
+                for (size_t i = 0; i < capacity; ++i) {
+                    if (m_pointers[i].active && m_pointers[i].pressed()) {
+                        if (0 == n) {
+                            a = static_cast<int>(i);
+                        } else if (1 == n) {
+                            b = static_cast<int>(i);
+                        }
+                        ++n;
+                    }
+                }
+                m_gesture.contacts = n;
+                m_gesture.dragging = 1 == n;
+                if (2 > n) {
+                    m_gesture.pinching = false;
+                    return;
+                }
+                const pointer_t& pa = m_pointers[static_cast<size_t>(a)];
+                const pointer_t& pb = m_pointers[static_cast<size_t>(b)];
+                const float dist = std::hypot(static_cast<float>(pb.x - pa.x), static_cast<float>(pb.y - pa.y));
+                m_gesture.pinch_x = static_cast<float>(pa.x + pb.x) * 0.5f;
+                m_gesture.pinch_y = static_cast<float>(pa.y + pb.y) * 0.5f;
+                if (!m_gesture.pinching || a != m_pinch_a || b != m_pinch_b) {
+                    m_gesture.pinching = true;
+                    m_gesture.pinch_scale = 1.0f;
+                    m_pinch_a = a;
+                    m_pinch_b = b;
+                    m_pinch_dist0 = dist;
+                    m_pinch_dist_last = dist;
+                } else if (0.0f < m_pinch_dist_last && 0.0f < m_pinch_dist0) {
+                    m_gesture.pinch_scale_delta *= dist / m_pinch_dist_last;
+                    m_gesture.pinch_scale = dist / m_pinch_dist0;
+                    m_pinch_dist_last = dist;
+                }
+            }
+
+        public:
+            /** Returns the pointer of given slot [0 .. capacity), check pointer_t::active. */
+            const pointer_t& operator[](size_t i) const noexcept { return m_pointers[i]; }
+            /** Returns the pointer of given type and id or nullptr. */
+            const pointer_t* get(pointer_type_t type, int id) const noexcept {
+                for (const pointer_t& p : m_pointers) {
+                    if (p.active && p.type == type && p.id == id) {
+                        return &p;
+                    }
+                }
+                return nullptr;
+            }
+            const gesture_t& gesture() const noexcept { return m_gesture; }
+
+            /** Enables or disables the per frame motion sample history, disabled by default. */
+            void set_sample_history(bool enable) noexcept {
+                m_sample_history = enable;
+                m_sample_count = 0;
+            }
+            bool sample_history() const noexcept { return m_sample_history; }
+            /** Returns the number of motion samples of this frame, see sample(). */
+            size_t sample_count() const noexcept { return m_sample_count; }
+            /** Returns the motion sample [0 .. sample_count()) of this frame in arrival order. */
+            const pointer_sample_t& sample(size_t i) const noexcept { return m_samples[i]; }
+
+            /** Appends a motion sample to the history if enabled, e.g. for each motion event folded into one coalesced motion. */
+            void add_sample(pointer_type_t type, int id, int x, int y, float pressure, const jau::fraction_timespec& t) noexcept {
+                if (!m_sample_history || sample_capacity <= m_sample_count) {
+                    return;
+                }
+                const pointer_t* p = find(type, id, pointer_type_t::mouse == type);
+                if (nullptr == p) {
+                    return;
+                }
+                if (0 == m_sample_count) {
+                    m_sample_t0 = t;
+                }
+                pointer_sample_t& s = m_samples[m_sample_count++];
+                s.slot = static_cast<uint8_t>(p - m_pointers.data());
+                s.pressure = static_cast<uint8_t>(std::lround(std::clamp(pressure, 0.0f, 1.0f) * 255.0f));
+                s.x = static_cast<int16_t>(std::clamp(x, INT16_MIN, INT16_MAX));
+                s.y = static_cast<int16_t>(std::clamp(y, INT16_MIN, INT16_MAX));
+                s.t_us = static_cast<uint16_t>(std::clamp<int64_t>((t - m_sample_t0).to_us(), 0, UINT16_MAX));
+            }
+
+            /** Clears all pointers and gestures. */
+            void clear() noexcept {
+                m_pointers.fill(pointer_t());
+                m_gesture = gesture_t();
+                m_pinch_a = m_pinch_b = -1;
+                m_sample_count = 0;
+            }
+
+            /**
+             * Merges the per frame state of given older state not consumed, i.e. adds its deltas and prepends its motion samples.
+             * See input_event_t::merge_previous().
+             */
+            void merge_previous(const pointer_state_t& older) noexcept {
+                for (size_t i = 0; i < capacity; ++i) {
+                    pointer_t& p = m_pointers[i];
+                    const pointer_t& o = older.m_pointers[i];
+                    if (p.active && o.active && p.type == o.type && p.id == o.id) {
+                        p.dx += o.dx;
+                        p.dy += o.dy;
+                    }
+                }
+                m_gesture.drag_dx += older.m_gesture.drag_dx;
+                m_gesture.drag_dy += older.m_gesture.drag_dy;
+                m_gesture.pinch_scale_delta *= older.m_gesture.pinch_scale_delta;
+                if (!m_sample_history || 0 == older.m_sample_count) {
+                    return;
+                }
+                const size_t n = older.m_sample_count;
+                const size_t kept = std::min(m_sample_count, sample_capacity - n);
+                const int64_t dt_us = 0 < m_sample_count ? (m_sample_t0 - older.m_sample_t0).to_us() : 0;
+                for (size_t i = kept; i-- > 0;) {
+                    pointer_sample_t& s = m_samples[n + i];
+                    s = m_samples[i];
+                    s.t_us = static_cast<uint16_t>(std::clamp<int64_t>(s.t_us + dt_us, 0, UINT16_MAX));
+                }
+                std::copy_n(older.m_samples.data(), n, m_samples.data());
+                m_sample_count = n + kept;
+                m_sample_t0 = older.m_sample_t0;
+            }
+
+            /** Resets per frame deltas and releases lifted touch contacts, called before applying the events of a new frame. */
+            void begin_frame() noexcept {
+                for (pointer_t& p : m_pointers) {
+                    p.dx = 0;
+                    p.dy = 0;
+                    if (pointer_type_t::touch == p.type && !p.pressed()) {
+                        p.active = false;
+                    }
+                }
+                m_gesture.drag_dx = 0;
+                m_gesture.drag_dy = 0;
+                m_gesture.pinch_scale_delta = 1.0f;
+                m_sample_count = 0;
+            }
+
+            /**
+             * Applies pointer motion to given position with given relative motion,
+             * the latter being the only valid movement in relative mouse mode.
+             */
+            void motion(pointer_type_t type, int id, int x, int y, int dx, int dy, float pressure, const jau::fraction_timespec& t) noexcept {
+                pointer_t* p = find(type, id, pointer_type_t::mouse == type);
+                if (nullptr == p) {
+                    return;
+                }
+                p->dx += dx;
+                p->dy += dy;
+                p->x = x;
+                p->y = y;
+                if (pointer_type_t::touch == type) {
+                    p->pressure = pressure;
+                }
+                p->t_last = t;
+                if (p->pressed()) {
+                    if (m_gesture.dragging) {
+                        m_gesture.drag_dx += dx;
+                        m_gesture.drag_dy += dy;
+                    }
+                    update_gesture();
+                }
+            }
+
+            /** Applies a button press or release at given position, button 1 is the primary button or touch contact. */
+            void button(pointer_type_t type, int id, int button, bool down, int x, int y, float pressure, const jau::fraction_timespec& t) noexcept {
+                pointer_t* p = find(type, id, down || pointer_type_t::mouse == type);
+                if (nullptr == p || 1 > button || 32 < button) {
+                    return;
+                }
+                const uint32_t m = 1U << (button - 1);
+                p->x = x;
+                p->y = y;
+                p->t_last = t;
+                if (down) {
+                    p->buttons |= m;
+                    p->down_x = x;
+                    p->down_y = y;
+                    p->t_down = t;
+                    p->pressure = pressure;
+                } else {
+                    p->buttons &= ~m;
+                    if (!p->pressed()) {
+                        p->pressure = 0.0f;
+                    }
+                }
+                update_gesture();
+            }
+    };
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_POINTER_HPP_ */
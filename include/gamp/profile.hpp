@@ -0,0 +1,93 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_PROFILE_HPP_
+#define JAU_GAMP_PROFILE_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include <jau/basic_types.hpp>
+#include <jau/fraction_type.hpp>
+
+/**
+ * CPU profiling zones, recorded per thread into lock-free rings and exported as Chrome trace JSON.
+ *
+ * Zones are only recorded if compiled with GAMP_PROFILE defined, see cmake option `GAMP_PROFILE`.
+ * Otherwise GAMP_PROFILE_ZONE() and GAMP_PROFILE_FRAME_MARK() compile to nothing.
+ *
+ * The resulting trace file can be loaded in `chrome://tracing` or [Perfetto](https://ui.perfetto.dev).
+ */
+namespace gamp::profile {
+    /** Maximum number of records per thread until write_chrome_trace() drains them, further records are dropped. */
+    constexpr size_t records_per_thread = 1U << 14;
+
+    /** Returns the monotonic time in nanoseconds. */
+    inline int64_t now_ns() noexcept {
+        const jau::fraction_timespec t = jau::getMonotonicTime();
+        return t.tv_sec * 1000000000 + t.tv_nsec;
+    }
+
+    /** Records a zone of the current thread. Given name must be a string literal or otherwise outlive the trace. */
+    void record_zone(const char* name, int64_t t0_ns, int64_t t1_ns) noexcept;
+    /** Records an instant frame marker of the current thread. Given name must be a string literal or otherwise outlive the trace. */
+    void frame_mark(const char* name) noexcept;
+    /** Returns the number of records dropped due to full per-thread rings. */
+    uint64_t dropped_records() noexcept;
+
+    /**
+     * Drains all recorded zones and frame markers of all threads into the given Chrome trace JSON file.
+     * Returns false on file I/O error.
+     */
+    bool write_chrome_trace(const std::string& path) noexcept;
+
+    /** Scoped zone, recording its lifetime via record_zone(). */
+    class zone_t {
+        private:
+            const char* m_name;
+            int64_t m_t0;
+
+        public:
+            explicit zone_t(const char* name) noexcept
+            : m_name(name), m_t0(now_ns()) {}
+            ~zone_t() noexcept { record_zone(m_name, m_t0, now_ns()); }
+
+            zone_t(const zone_t&) = delete;
+            zone_t& operator=(const zone_t&) = delete;
+    };
+}  // namespace gamp::profile
+
+#define GAMP_PROFILE_CONCAT_(a, b) a##b
+#define GAMP_PROFILE_CONCAT(a, b)  GAMP_PROFILE_CONCAT_(a, b)
+
+#if defined(GAMP_PROFILE)
+    /** Records a profiling zone for the remaining enclosing scope. */
+    #define GAMP_PROFILE_ZONE(name)       ::gamp::profile::zone_t GAMP_PROFILE_CONCAT(gamp_profile_zone_, __LINE__)(name)
+    /** Records an instant frame marker. */
+    #define GAMP_PROFILE_FRAME_MARK(name) ::gamp::profile::frame_mark(name)
+#else
+    #define GAMP_PROFILE_ZONE(name)
+    #define GAMP_PROFILE_FRAME_MARK(name)
+#endif
+
+#endif /*  JAU_GAMP_PROFILE_HPP_ */
@@ -0,0 +1,98 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_SPSC_RING_HPP_
+#define JAU_GAMP_SPSC_RING_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace gamp {
+
+    /**
+     * Bounded lock-free single producer, single consumer ring buffer of fixed capacity N.
+     *
+     * push() shall only be called by the producer thread,
+     * pop() only by the consumer thread.
+     * Neither blocks nor allocates, a full ring rejects push().
+     *
+     * @tparam T element type, moved in and out
+     * @tparam N capacity, must be a power of two
+     */
+    template<typename T, size_t N>
+    class spsc_ring_t {
+        static_assert(0 < N && 0 == (N & (N - 1)), "N must be a power of two");
+
+        private:
+            constexpr static size_t mask = N - 1;
+            std::array<T, N> m_buf;
+            alignas(64) std::atomic<size_t> m_head{0};  // next write position, owned by producer
+            alignas(64) std::atomic<size_t> m_tail{0};  // next read position, owned by consumer
+
+        public:
+            constexpr static size_t capacity() noexcept { return N; }
+
+            /** Returns the number of elements, only a snapshot if called concurrently. */
+            size_t size() const noexcept {
+                return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+            }
+            bool empty() const noexcept { return 0 == size(); }
+
+            /** Producer: Appends v, returns false if full. */
+            bool push(const T& v) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+                const size_t h = m_head.load(std::memory_order_relaxed);
+                if (h - m_tail.load(std::memory_order_acquire) == N) {
+                    return false;
+                }
+                m_buf[h & mask] = v;
+                m_head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+            /** Producer: Appends v, returns false if full. */
+            bool push(T&& v) noexcept(std::is_nothrow_move_assignable_v<T>) {
+                const size_t h = m_head.load(std::memory_order_relaxed);
+                if (h - m_tail.load(std::memory_order_acquire) == N) {
+                    return false;
+                }
+                m_buf[h & mask] = std::move(v);
+                m_head.store(h + 1, std::memory_order_release);
+                return true;
+            }
+            /** Consumer: Moves the oldest element into out, returns false if empty. */
+            bool pop(T& out) noexcept(std::is_nothrow_move_assignable_v<T>) {
+                const size_t t = m_tail.load(std::memory_order_relaxed);
+                if (t == m_head.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                out = std::move(m_buf[t & mask]);
+                m_tail.store(t + 1, std::memory_order_release);
+                return true;
+            }
+    };
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_SPSC_RING_HPP_ */
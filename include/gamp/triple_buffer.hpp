@@ -0,0 +1,123 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_TRIPLE_BUFFER_HPP_
+#define JAU_GAMP_TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace gamp {
+
+    /**
+     * Lock-free single producer, single consumer triple buffer of the latest value of T.
+     *
+     * The producer fills back() and publishes it via publish(), never waiting for the consumer.
+     * The consumer acquires the latest published value via update() and reads it via front(),
+     * which stays immutable until the next update(). Intermediate values published in between are skipped,
+     * see sequence() to detect them, or merged into the next value via publish_merged().
+     *
+     * publish() shall only be called by the producer thread,
+     * update() and front() only by the consumer thread.
+     * Neither blocks nor allocates.
+     *
+     * @tparam T value type, copy assignable
+     */
+    template<typename T>
+    class triple_buffer_t {
+        private:
+            struct slot_t {
+                T value;
+                /** Publish sequence number, starting with 1. */
+                uint64_t seq = 0;
+            };
+            constexpr static uint32_t index_mask = 3;
+            /** Flag of m_middle denoting a published value not yet acquired by the consumer. */
+            constexpr static uint32_t fresh_bit = 4;
+            /** Flag of m_middle denoting the producer merging the fresh value, see publish_merged(). */
+            constexpr static uint32_t lock_bit = 8;
+
+            std::array<slot_t, 3> m_slots;
+            alignas(64) size_t m_back = 0;   // owned by producer
+            uint64_t m_seq = 0;              // owned by producer
+            alignas(64) std::atomic<uint32_t> m_middle{1};  // slot index and fresh_bit, exchanged by both
+            alignas(64) size_t m_front = 2;  // owned by consumer
+
+        public:
+            /** Producer: Returns the back buffer to be filled, holding a stale value. */
+            T& back() noexcept { return m_slots[m_back].value; }
+
+            /** Producer: Publishes the back buffer as the latest value, the back buffer becomes a stale one. */
+            void publish() noexcept {
+                m_slots[m_back].seq = ++m_seq;
+                m_back = m_middle.exchange(static_cast<uint32_t>(m_back) | fresh_bit, std::memory_order_acq_rel) & index_mask;
+            }
+            /**
+             * Producer: Publishes the back buffer like publish(), however if the previously published value
+             * has not been acquired by the consumer, `merge(back(), previous)` is called before, e.g. accumulating per value state.
+             * The previous value is never acquired afterwards, i.e. each published value is acquired once, either directly or merged.
+             * Meanwhile update() returns false.
+             *
+             * @param merge function `void(T& newer, const T& older)`
+             */
+            template<typename F>
+            void publish_merged(F merge) {
+                uint32_t mid = m_middle.load(std::memory_order_acquire);
+                while (0 != (mid & fresh_bit)) {
+                    if (m_middle.compare_exchange_weak(mid, mid | lock_bit, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        merge(m_slots[m_back].value, std::as_const(m_slots[mid & index_mask].value));
+                        break;
+                    }
+                }
+                publish();
+            }
+            /** Producer: Copies v into the back buffer and publishes it. */
+            void publish(const T& v) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+                back() = v;
+                publish();
+            }
+
+            /** Consumer: Acquires the latest published value as front(), returns false if none has been published since. */
+            bool update() noexcept {
+                uint32_t mid = m_middle.load(std::memory_order_relaxed);
+                do {
+                    if (0 == (mid & fresh_bit) || 0 != (mid & lock_bit)) {
+                        return false;
+                    }
+                } while (!m_middle.compare_exchange_weak(mid, static_cast<uint32_t>(m_front), std::memory_order_acq_rel, std::memory_order_relaxed));
+                m_front = mid & index_mask;
+                return true;
+            }
+            /** Consumer: Returns the value acquired by the last update(), default constructed if none. */
+            const T& front() const noexcept { return m_slots[m_front].value; }
+            /** Consumer: Returns the publish sequence number of front(), starting with 1 or 0 if none. */
+            uint64_t sequence() const noexcept { return m_slots[m_front].seq; }
+    };
+
+}  // namespace gamp
+
+#endif /*  JAU_GAMP_TRIPLE_BUFFER_HPP_ */
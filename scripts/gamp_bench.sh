@@ -0,0 +1 @@
+run-native-example.sh
\ No newline at end of file
@@ -0,0 +1,323 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+using namespace gamp;
+
+/** Render scale granularity, limiting the number of distinct scene sizes. */
+static constexpr float dynres_scale_step = 0.05f;
+
+static bool dynres_enabled = false;
+static float dynres_min_scale = 0.5f;
+/** Atomic as read by get_render_scale(), while written by the render thread if running. */
+static std::atomic<float> dynres_scale{1.0f};
+static int dynres_good_windows = 0;
+static int dynres_window_frames = 0;
+static duration_histogram_t dynres_histogram;
+
+/** Scene framebuffer of the native viewport size, rendered into its scaled lower left part. */
+static impl::fbo_t dynres_fbo;
+/** Native viewport saved by begin_scene() and scaled scene size. */
+static GLint dynres_native[4] = { 0, 0, 0, 0 };
+static int dynres_scene_width = 0;
+static int dynres_scene_height = 0;
+static bool dynres_scene_active = false;
+
+/** Framebuffer blit of ES3 or GL_NV_framebuffer_blit, sharing signature and enum values. */
+static PFNGLBLITFRAMEBUFFERNVPROC glBlitFramebuffer_ = nullptr;
+static bool dynres_gl_init = false;
+/** Textured quad upscaling without framebuffer blit, e.g. ES2 and WebGL1. */
+static GLuint dynres_program = 0;
+static GLuint dynres_vbo = 0;
+static GLint dynres_u_scale = -1;
+
+static constexpr const char* dynres_vertex_source =
+    "attribute vec2 a_pos;\n"
+    "uniform vec2 u_scale;\n"
+    "varying vec2 v_tc;\n"
+    "void main() {\n"
+    "    v_tc = (a_pos * 0.5 + 0.5) * u_scale;\n"
+    "    gl_Position = vec4(a_pos, 0.0, 1.0);\n"
+    "}\n";
+static constexpr const char* dynres_fragment_source =
+    "precision mediump float;\n"
+    "uniform sampler2D u_tex;\n"
+    "varying vec2 v_tc;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(u_tex, v_tc);\n"
+    "}\n";
+
+static GLuint compile_shader(GLenum type, const char* source) noexcept {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (GL_TRUE != ok) {
+        log_printf(log_level_t::error, "Dynamic resolution: Error compiling shader\n");
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+/** Creates the upscaling program and quad, restoring the current program and array buffer. */
+static bool create_upscale_program() noexcept {
+    const GLuint vs = compile_shader(GL_VERTEX_SHADER, dynres_vertex_source);
+    const GLuint fs = compile_shader(GL_FRAGMENT_SHADER, dynres_fragment_source);
+    if (0 == vs || 0 == fs) {
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return false;
+    }
+    dynres_program = glCreateProgram();
+    glAttachShader(dynres_program, vs);
+    glAttachShader(dynres_program, fs);
+    glBindAttribLocation(dynres_program, 0, "a_pos");
+    glLinkProgram(dynres_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(dynres_program, GL_LINK_STATUS, &ok);
+    if (GL_TRUE != ok) {
+        log_printf(log_level_t::error, "Dynamic resolution: Error linking program\n");
+        glDeleteProgram(dynres_program);
+        dynres_program = 0;
+        return false;
+    }
+    GLint program0 = 0, vbo0 = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program0);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &vbo0);
+    glUseProgram(dynres_program);
+    glUniform1i(glGetUniformLocation(dynres_program, "u_tex"), 0);
+    dynres_u_scale = glGetUniformLocation(dynres_program, "u_scale");
+    glUseProgram(static_cast<GLuint>(program0));
+
+    static constexpr GLfloat quad[] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    glGenBuffers(1, &dynres_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, dynres_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(vbo0));
+    return true;
+}
+
+static void destroy_gl_resources() noexcept {
+    if (0 != dynres_fbo.fbo) {
+        impl::destroy_fbo(dynres_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer());
+    }
+    if (0 != dynres_program) {
+        glDeleteProgram(dynres_program);
+        dynres_program = 0;
+    }
+    if (0 != dynres_vbo) {
+        glDeleteBuffers(1, &dynres_vbo);
+        dynres_vbo = 0;
+    }
+    glBlitFramebuffer_ = nullptr;
+    dynres_gl_init = false;
+}
+
+static bool init_gl_resources() noexcept {
+    dynres_gl_init = true;
+    if (gl_caps.framebuffer_blit) {
+        glBlitFramebuffer_ = reinterpret_cast<PFNGLBLITFRAMEBUFFERNVPROC>(impl::get_gl_proc_address(gl_caps.es3 ? "glBlitFramebuffer" : "glBlitFramebufferNV"));
+    }
+    if (nullptr == glBlitFramebuffer_ && !create_upscale_program()) {
+        return false;
+    }
+    log_printf(log_level_t::info, "Dynamic resolution: Upscaling via %s\n", nullptr != glBlitFramebuffer_ ? "framebuffer blit" : "textured quad");
+    return true;
+}
+
+/** Draws the scene texture scaled to the current viewport, restoring the GL state it touches. */
+static void draw_upscale_quad() noexcept {
+    GLint program0 = 0, vbo0 = 0, active_tex0 = 0, tex0 = 0;
+    GLint attr_enabled0 = 0, attr_vbo0 = 0, attr_size0 = 4, attr_type0 = GL_FLOAT, attr_norm0 = 0, attr_stride0 = 0;
+    void* attr_ptr0 = nullptr;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program0);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &vbo0);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active_tex0);
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &tex0);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &attr_enabled0);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &attr_vbo0);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attr_size0);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attr_type0);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attr_norm0);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &attr_stride0);
+    glGetVertexAttribPointerv(0, GL_VERTEX_ATTRIB_ARRAY_POINTER, &attr_ptr0);
+    const GLboolean depth_test0 = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean blend0 = glIsEnabled(GL_BLEND);
+    const GLboolean cull0 = glIsEnabled(GL_CULL_FACE);
+    const GLboolean scissor0 = glIsEnabled(GL_SCISSOR_TEST);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_SCISSOR_TEST);
+    glUseProgram(dynres_program);
+    glUniform2f(dynres_u_scale, static_cast<float>(dynres_scene_width) / static_cast<float>(dynres_fbo.width),
+                static_cast<float>(dynres_scene_height) / static_cast<float>(dynres_fbo.height));
+    glBindTexture(GL_TEXTURE_2D, dynres_fbo.color);
+    glBindBuffer(GL_ARRAY_BUFFER, dynres_vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(attr_vbo0));
+    glVertexAttribPointer(0, attr_size0, static_cast<GLenum>(attr_type0), static_cast<GLboolean>(attr_norm0), attr_stride0, attr_ptr0);
+    if (0 == attr_enabled0) {
+        glDisableVertexAttribArray(0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(vbo0));
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(tex0));
+    glActiveTexture(static_cast<GLenum>(active_tex0));
+    glUseProgram(static_cast<GLuint>(program0));
+    if (depth_test0) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    if (blend0) {
+        glEnable(GL_BLEND);
+    }
+    if (cull0) {
+        glEnable(GL_CULL_FACE);
+    }
+    if (scissor0) {
+        glEnable(GL_SCISSOR_TEST);
+    }
+}
+
+void gamp::set_dynamic_resolution(bool enable, float min_scale) noexcept {
+    dynres_min_scale = std::clamp(min_scale, 0.25f, 1.0f);
+    if (enable != dynres_enabled) {
+        dynres_enabled = enable;
+        dynres_scale.store(1.0f, std::memory_order_relaxed);
+        dynres_good_windows = 0;
+        dynres_window_frames = 0;
+        dynres_histogram.clear();
+    }
+}
+bool gamp::get_dynamic_resolution() noexcept {
+    return dynres_enabled;
+}
+float gamp::get_render_scale() noexcept {
+    return dynres_enabled ? dynres_scale.load(std::memory_order_relaxed) : 1.0f;
+}
+
+void gamp::begin_scene() noexcept {
+    if (!dynres_enabled) {
+        if (dynres_gl_init) {
+            destroy_gl_resources();  // free the scene framebuffer
+        }
+        return;
+    }
+    if (!dynres_gl_init && !init_gl_resources()) {
+        log_printf(log_level_t::error, "Dynamic resolution: Not supported, disabled\n");
+        destroy_gl_resources();
+        dynres_enabled = false;
+        return;
+    }
+    glGetIntegerv(GL_VIEWPORT, dynres_native);
+    const int width = dynres_native[2], height = dynres_native[3];
+    if (0 >= width || 0 >= height) {
+        return;
+    }
+    if (width != dynres_fbo.width || height != dynres_fbo.height) {
+        if (0 != dynres_fbo.fbo) {
+            impl::destroy_fbo(dynres_fbo);
+        }
+        if (!impl::create_fbo(dynres_fbo, width, height, gl_caps.es3, nullptr == glBlitFramebuffer_)) {
+            log_printf(log_level_t::error, "Dynamic resolution: Error creating scene framebuffer %d x %d, disabled\n", width, height);
+            destroy_gl_resources();
+            dynres_enabled = false;
+            return;
+        }
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, dynres_fbo.fbo);
+    }
+    const float scale = dynres_scale.load(std::memory_order_relaxed);
+    dynres_scene_width = std::max(1, static_cast<int>(std::lround(static_cast<float>(width) * scale)));
+    dynres_scene_height = std::max(1, static_cast<int>(std::lround(static_cast<float>(height) * scale)));
+    glViewport(0, 0, dynres_scene_width, dynres_scene_height);
+    dynres_scene_active = true;
+}
+
+void gamp::end_scene() noexcept {
+    if (!dynres_scene_active) {
+        return;
+    }
+    GAMP_PROFILE_ZONE("end_scene");
+    dynres_scene_active = false;
+    const GLint x0 = dynres_native[0], y0 = dynres_native[1];
+    const GLint x1 = x0 + dynres_native[2], y1 = y0 + dynres_native[3];
+    if (nullptr != glBlitFramebuffer_) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER_NV, dynres_fbo.fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER_NV, default_framebuffer());
+        glBlitFramebuffer_(0, 0, dynres_scene_width, dynres_scene_height, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer());
+        glViewport(x0, y0, dynres_native[2], dynres_native[3]);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer());
+        glViewport(x0, y0, dynres_native[2], dynres_native[3]);
+        draw_upscale_quad();
+    }
+}
+
+void impl::dynamic_resolution_update(uint64_t cost_us, int budget_fps) noexcept {
+    if (!dynres_enabled || 0 >= budget_fps) {
+        return;
+    }
+    dynres_histogram.add(cost_us);
+    if (++dynres_window_frames < std::max(15, budget_fps / 2)) {
+        return;
+    }
+    const uint64_t p90_us = dynres_histogram.percentile_us(0.90);
+    dynres_histogram.clear();
+    dynres_window_frames = 0;
+    const uint64_t budget_us = 1000000 / static_cast<uint64_t>(budget_fps);
+    const float scale0 = dynres_scale.load(std::memory_order_relaxed);
+    if (p90_us * 100 > budget_us * 90) {
+        // fill rate bound costs scale with the pixel count, i.e. the square of the scale
+        const float target = scale0 * std::sqrt(static_cast<float>(budget_us) * 0.80f / static_cast<float>(p90_us));
+        const float scale = std::floor(std::min(target, scale0 - dynres_scale_step) / dynres_scale_step + 0.001f) * dynres_scale_step;
+        dynres_scale.store(std::max(dynres_min_scale, scale), std::memory_order_relaxed);
+        dynres_good_windows = 0;
+    } else if (scale0 < 1.0f && p90_us * 100 < budget_us * 70) {
+        // raise slowly, as not all costs scale with the resolution
+        if (++dynres_good_windows >= 2) {
+            dynres_scale.store(std::min(1.0f, scale0 + dynres_scale_step), std::memory_order_relaxed);
+            dynres_good_windows = 0;
+        }
+    } else {
+        dynres_good_windows = 0;
+    }
+}
@@ -23,7 +23,11 @@
  */
 #include "gamp/gamp.hpp"
 
+#include <atomic>
+#include <cinttypes>
+#include <cstdarg>
 #include <cstdint>
+#include <cstdio>
 #include <ctime>
 #include <jau/environment.hpp>
 
@@ -33,20 +37,62 @@ float gamp::devicePixelRatio[] = { 1, 1 };
 int gamp::display_frames_per_sec=60;
 int gamp::forced_fps = -1;
 jau::util::VersionNumber gamp::gl_version;
+gamp::gl_caps_t gamp::gl_caps;
+
+static std::atomic<gamp::log_level_t> log_level{gamp::log_level_t::info};
+
+void gamp::set_log_level(log_level_t level) noexcept {
+    log_level.store(level, std::memory_order_relaxed);
+}
+gamp::log_level_t gamp::get_log_level() noexcept {
+    return log_level.load(std::memory_order_relaxed);
+}
+bool gamp::is_log_enabled(log_level_t level) noexcept {
+    return log_level_t::none != level && level <= log_level.load(std::memory_order_relaxed);
+}
+void gamp::log_printf(log_level_t level, const char* format, ...) noexcept {
+    if (!is_log_enabled(level)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stdout, format, args);
+    va_end(args);
+}
 
 //
 //
 //
 std::string gamp::input_event_t::to_string() const noexcept {
     return "event[p1 "+std::to_string(has_any_p1())+
-            ", pressed "+std::to_string(m_pressed)+", p1_mask "+std::to_string(p1_mask)+
+            ", pressed "+std::to_string(m_pressed.count())+
             ", p2 "+std::to_string(has_any_p2())+
             ", paused "+std::to_string(paused())+
             ", close "+std::to_string(pressed( gamp::input_event_type_t::WINDOW_CLOSE_REQ ))+
             ", last "+std::to_string((int)last)+", key "+std::to_string(last_key_code)+
-            ", text "+text+
+            ", text "+text.to_string()+
             ", ptr["+std::to_string(pointer_id)+" "+std::to_string(pointer_x)+"/"+
             std::to_string(pointer_y)+"]]"
             ;
 }
 
+static gamp::input_snapshot_t input_snapshot_;
+static bool input_snapshot_publish = false;
+
+gamp::input_snapshot_t& gamp::input_snapshot() noexcept {
+    return input_snapshot_;
+}
+void gamp::set_input_snapshot_publish(bool enable) noexcept {
+    input_snapshot_publish = enable;
+}
+bool gamp::get_input_snapshot_publish() noexcept {
+    return input_snapshot_publish;
+}
+
+
+std::string gamp::duration_percentiles_t::toString() const noexcept {
+    char buf[192];
+    snprintf(buf, sizeof(buf), "frames %" PRIu64 ", p50 %.3fms, p95 %.3fms, p99 %.3fms, max %.3fms, over-budget %" PRIu64,
+             count, p50 * 1000.0, p95 * 1000.0, p99 * 1000.0, max * 1000.0, over_budget);
+    return std::string(buf);
+}
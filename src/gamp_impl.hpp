@@ -0,0 +1,169 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef JAU_GAMP_IMPL_HPP_
+#define JAU_GAMP_IMPL_HPP_
+
+#include <gamp/gamp.hpp>
+
+/**
+ * Library internal functionality shared between the GFX toolkit and the GL implementation units, not exported.
+ */
+namespace gamp::impl {
+    //
+    // gfx toolkit dependent, sdl_subsys.cpp
+    //
+
+    /** GFX Toolkit: Returns the GL function address of given name for the current context, or nullptr if not available. */
+    void* get_gl_proc_address(const char* name) noexcept;
+    /** GFX Toolkit: Makes the primary GL context current on the calling thread or releases it, returns false on failure. */
+    bool make_gl_context_current(bool current) noexcept;
+    /** GFX Toolkit: Applies given resize of the primary window to win_width, win_height, viewport and the GL viewport, if pending. To be called on the rendering thread. */
+    void apply_resize(const render_frame_t::resize_t& r) noexcept;
+    /** GFX Toolkit: Returns and clears the resize of the primary window pending for the render thread, see submit_render_frame(). */
+    render_frame_t::resize_t take_pending_resize() noexcept;
+    /**
+     * Returns and clears the OS timestamp in nanoseconds of the oldest input event handled since the last call, zero if none.
+     * Called on the thread handling events for the frame consuming the input, i.e. by swap_gpu_buffer() or submit_render_frame().
+     */
+    int64_t take_input_latency_t0() noexcept;
+    /** GFX Toolkit: Presents the frame like swap_gpu_buffer(), measuring the input latency of given input timestamp, see take_input_latency_t0(). */
+    void present_frame(int fps, int64_t input_t0_ns) noexcept;
+
+    /** GL context sharing objects with the primary context, bound to a hidden window. */
+    struct shared_gl_context_t {
+        void* win = nullptr;
+        void* glc = nullptr;
+    };
+    /** GFX Toolkit: Creates a shared GL context, to be called on the thread the primary context is current, which remains current. */
+    bool create_shared_gl_context(shared_gl_context_t& ctx) noexcept;
+    /** GFX Toolkit: Makes given shared GL context current on the calling thread or releases it, returns false on failure. */
+    bool make_shared_gl_context_current(const shared_gl_context_t& ctx, bool current) noexcept;
+    /** GFX Toolkit: Destroys given shared GL context, which shall not be current on any thread. */
+    void destroy_shared_gl_context(shared_gl_context_t& ctx) noexcept;
+
+    //
+    // Render thread, render_thread.cpp
+    //
+
+    /** Returns true if the render thread owns the GL context, see start_render_thread(). */
+    bool render_thread_active() noexcept;
+
+    //
+    // Game controller, sdl_controller.cpp
+    //
+
+    /** Notifies a controller device being added or removed, may be called from the event polling thread. */
+    void on_controller_hotplug() noexcept;
+
+    //
+    // Input record and replay, input_record.cpp
+    //
+
+    /** Appends given event to the recording, if active. */
+    void input_record(const event_t& e) noexcept;
+    /** Marks the end of a frame, i.e. appends a frame marker to the recording or releases the next frame of a fast replay. */
+    void input_record_end_frame() noexcept;
+    /** Returns true if an input replay is active, replacing live input. */
+    bool input_replay_active() noexcept;
+    /** Fills given array with the replayed events due, returns their number. */
+    size_t input_replay_poll(std::span<event_t> events) noexcept;
+
+    //
+    // Key bindings, sdl_keymap.cpp
+    //
+
+    typedef std::array<input_event_type_t, scancode_count> key_action_table_t;
+    typedef std::array<uint16_t, scancode_count> key_ascii_table_t;
+    /** Action per scancode, see bind_key(). */
+    extern key_action_table_t key_action_table;
+    /** ASCII code per scancode, 0 if none. */
+    extern const key_ascii_table_t key_ascii_table;
+
+    /** Returns the action bound to given scancode, branch-free for scancodes within [0 .. scancode_count). */
+    inline input_event_type_t key_action(int scancode) noexcept {
+        return key_action_table[static_cast<size_t>(scancode) & (scancode_count - 1)];
+    }
+    /** Returns the ASCII code of given scancode or 0, branch-free for scancodes within [0 .. scancode_count). */
+    inline uint16_t key_ascii(int scancode) noexcept {
+        return key_ascii_table[static_cast<size_t>(scancode) & (scancode_count - 1)];
+    }
+
+    //
+    // GL capabilities, gl_caps.cpp
+    //
+
+    /** Probes the capabilities of the current context into gl_caps, once after creating the primary context. */
+    void probe_gl_caps() noexcept;
+
+    //
+    // Offscreen framebuffer, gl_framebuffer.cpp
+    //
+
+    /** GL framebuffer object with color and depth attachments. */
+    struct fbo_t {
+        uint32_t fbo = 0;
+        /** Color renderbuffer, or texture if color_texture. */
+        uint32_t color = 0;
+        uint32_t depth = 0;
+        int width = 0;
+        int height = 0;
+        bool color_texture = false;
+    };
+    /**
+     * Creates and binds a framebuffer object of given size in pixels for the current context.
+     * Uses RGBA8 and 24 bit depth if supported, i.e. ES3 or via extensions, otherwise RGBA4 and 16 bit depth.
+     * If color_texture, the color attachment is a linear filtered RGBA8 texture, e.g. to be sampled for upscaling.
+     * Returns false if incomplete, leaving fbo cleared.
+     */
+    bool create_fbo(fbo_t& fbo, int width, int height, bool es3, bool color_texture = false) noexcept;
+    /** Deletes the framebuffer object and its attachments, clearing fbo. */
+    void destroy_fbo(fbo_t& fbo) noexcept;
+
+    //
+    // Dynamic resolution, dynamic_resolution.cpp
+    //
+
+    /** Adjusts the render scale by the frame cost of the last frame, if enabled. To be called once per frame by swap_gpu_buffer(). */
+    void dynamic_resolution_update(uint64_t cost_us, int budget_fps) noexcept;
+
+    //
+    // GPU timer queries, gpu_timer.cpp
+    //
+
+    /** Initializes GPU timer queries for the current context, returns true if supported. */
+    bool gpu_timer_init() noexcept;
+    /** Ends the current frame's timer query, call right before swapping buffers. */
+    void gpu_timer_end_frame() noexcept;
+    /**
+     * Collects all available timer query results without blocking and begins the next frame's query,
+     * call right after swapping buffers.
+     * @param budget_fps frames per seconds, defining the over-budget threshold
+     * @return maximum GPU time of the collected results in microseconds, zero if none collected
+     */
+    uint64_t gpu_timer_begin_frame(int budget_fps) noexcept;
+    /** Returns the GPU statistics of the ending period via given references and resets the period accumulation. */
+    void gpu_timer_end_period(double& gpu_costs, duration_percentiles_t& gpu_pct) noexcept;
+}  // namespace gamp::impl
+
+#endif /*  JAU_GAMP_IMPL_HPP_ */
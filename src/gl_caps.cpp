@@ -0,0 +1,124 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <string_view>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+using namespace gamp;
+
+/** Extension names in gl_ext_t order. */
+static constexpr const char* gl_ext_names[] = {
+    "GL_ANGLE_instanced_arrays",
+    "GL_APPLE_sync",
+    "GL_ARB_timer_query",
+    "GL_EXT_color_buffer_float",
+    "GL_EXT_color_buffer_half_float",
+    "GL_EXT_disjoint_timer_query",
+    "GL_EXT_disjoint_timer_query_webgl2",
+    "GL_EXT_instanced_arrays",
+    "GL_EXT_texture_filter_anisotropic",
+    "GL_KHR_debug",
+    "GL_NV_framebuffer_blit",
+    "GL_OES_depth24",
+    "GL_OES_element_index_uint",
+    "GL_OES_get_program_binary",
+    "GL_OES_packed_depth_stencil",
+    "GL_OES_rgb8_rgba8",
+    "GL_OES_standard_derivatives",
+    "GL_OES_texture_float",
+    "GL_OES_texture_float_linear",
+    "GL_OES_texture_half_float",
+    "GL_OES_texture_npot",
+    "GL_OES_vertex_array_object",
+};
+static_assert(sizeof(gl_ext_names) / sizeof(gl_ext_names[0]) == static_cast<size_t>(gl_ext_t::count_));
+
+const char* gamp::gl_ext_name(gl_ext_t ext) noexcept {
+    return ext < gl_ext_t::count_ ? gl_ext_names[static_cast<size_t>(ext)] : "";
+}
+
+/** Returns the bitset of tracked extensions within given space separated extension string, parsed once. */
+static uint64_t parse_extensions(std::string_view exts) noexcept {
+    uint64_t bits = 0;
+    while (!exts.empty()) {
+        const size_t end = std::min(exts.find(' '), exts.size());
+        const std::string_view name = exts.substr(0, end);
+        for (size_t i = 0; i < static_cast<size_t>(gl_ext_t::count_); ++i) {
+            if (name == gl_ext_names[i]) {
+                bits |= uint64_t(1) << i;
+                break;
+            }
+        }
+        exts.remove_prefix(std::min(end + 1, exts.size()));
+    }
+    return bits;
+}
+
+static int get_integer(GLenum pname) noexcept {
+    GLint v = 0;
+    glGetIntegerv(pname, &v);
+    return v;
+}
+
+void impl::probe_gl_caps() noexcept {
+    gl_caps_t c;
+    const char* exts = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));  // still valid on ES3 and WebGL2
+    c.extensions = nullptr != exts ? parse_extensions(exts) : 0;
+    c.es3 = gl_version.major() >= 3;
+    c.max_texture_size = get_integer(GL_MAX_TEXTURE_SIZE);
+    c.max_renderbuffer_size = get_integer(GL_MAX_RENDERBUFFER_SIZE);
+    c.max_texture_image_units = get_integer(GL_MAX_TEXTURE_IMAGE_UNITS);
+    c.max_vertex_attribs = get_integer(GL_MAX_VERTEX_ATTRIBS);
+    c.max_vertex_uniform_vectors = get_integer(GL_MAX_VERTEX_UNIFORM_VECTORS);
+    c.max_fragment_uniform_vectors = get_integer(GL_MAX_FRAGMENT_UNIFORM_VECTORS);
+    c.instancing = c.es3 || c.has(gl_ext_t::ANGLE_instanced_arrays) || c.has(gl_ext_t::EXT_instanced_arrays);
+    c.vertex_array_object = c.es3 || c.has(gl_ext_t::OES_vertex_array_object);
+    c.timer_query = c.has(gl_ext_t::EXT_disjoint_timer_query) || c.has(gl_ext_t::EXT_disjoint_timer_query_webgl2) ||
+                    c.has(gl_ext_t::ARB_timer_query);
+    c.float_texture = c.es3 || c.has(gl_ext_t::OES_texture_float);
+    c.float_render_target = c.has(gl_ext_t::EXT_color_buffer_float) || c.has(gl_ext_t::EXT_color_buffer_half_float);
+    c.framebuffer_blit = c.es3 || c.has(gl_ext_t::NV_framebuffer_blit);
+    c.fence_sync = c.es3 || c.has(gl_ext_t::APPLE_sync);
+    if (c.es3 || c.has(gl_ext_t::OES_get_program_binary)) {
+        c.program_binary_formats = get_integer(GL_NUM_PROGRAM_BINARY_FORMATS_OES);  // same value as ES3
+    }
+    gl_caps = c;
+    log_printf(log_level_t::info, "GL caps: %s\n", gl_caps.toString().c_str());
+}
+
+std::string gamp::gl_caps_t::toString() const noexcept {
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+             "%s, tex %d, rb %d, units %d, attribs %d, uniforms %d/%d, instancing %d, vao %d, timer %d, "
+             "float-tex %d, float-rt %d, blit %d, fence %d, binary-formats %d, ext 0x%" PRIx64,
+             es3 ? "ES3" : "ES2", max_texture_size, max_renderbuffer_size, max_texture_image_units, max_vertex_attribs,
+             max_vertex_uniform_vectors, max_fragment_uniform_vectors, instancing, vertex_array_object, timer_query,
+             float_texture, float_render_target, framebuffer_blit, fence_sync, program_binary_formats, extensions);
+    return std::string(buf);
+}
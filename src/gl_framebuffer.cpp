@@ -0,0 +1,98 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <cstdio>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+using namespace gamp;
+
+bool impl::create_fbo(fbo_t& fbo, int width, int height, bool es3, bool color_texture) noexcept {
+    const bool rgba8 = es3 || gl_caps.has(gl_ext_t::OES_rgb8_rgba8);
+    const bool depth24 = es3 || gl_caps.has(gl_ext_t::OES_depth24);
+
+    GLuint names[2];
+    glGenFramebuffers(1, names);
+    fbo.fbo = names[0];
+    glGenRenderbuffers(color_texture ? 1 : 2, names);
+    fbo.depth = names[0];
+    fbo.width = width;
+    fbo.height = height;
+    fbo.color_texture = color_texture;
+
+    if (color_texture) {
+        glGenTextures(1, &fbo.color);
+        GLint tex0 = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &tex0);
+        glBindTexture(GL_TEXTURE_2D, fbo.color);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);  // required for NPOT on ES2
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(tex0));
+    } else {
+        fbo.color = names[1];
+        glBindRenderbuffer(GL_RENDERBUFFER, fbo.color);
+        glRenderbufferStorage(GL_RENDERBUFFER, rgba8 ? GL_RGBA8_OES : GL_RGBA4, width, height);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, fbo.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, depth24 ? GL_DEPTH_COMPONENT24_OES : GL_DEPTH_COMPONENT16, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo.fbo);
+    if (color_texture) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fbo.color, 0);
+    } else {
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, fbo.color);
+    }
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, fbo.depth);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (GL_FRAMEBUFFER_COMPLETE != status) {
+        printf("GL: Framebuffer %d x %d incomplete: 0x%X\n", width, height, status);
+        destroy_fbo(fbo);
+        return false;
+    }
+    return true;
+}
+
+void impl::destroy_fbo(fbo_t& fbo) noexcept {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (0 != fbo.fbo) {
+        glDeleteFramebuffers(1, &fbo.fbo);
+    }
+    if (0 != fbo.color) {
+        if (fbo.color_texture) {
+            glDeleteTextures(1, &fbo.color);
+        } else {
+            glDeleteRenderbuffers(1, &fbo.color);
+        }
+    }
+    if (0 != fbo.depth) {
+        glDeleteRenderbuffers(1, &fbo.depth);
+    }
+    fbo = fbo_t();
+}
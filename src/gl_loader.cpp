@@ -0,0 +1,239 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+using namespace gamp;
+
+namespace {
+    struct completed_upload_t {
+        gl_upload_t job;
+        bool ok;
+        /** Fence of the job's GL commands, null if completed via glFinish(). */
+        GLsync sync;
+    };
+}
+
+static impl::shared_gl_context_t loader_glc;
+static std::thread loader_thread;
+static std::atomic<bool> loader_running{false};
+/** Released by the loader thread once it has acquired its GL context or failed, see loader_ok. */
+static std::binary_semaphore loader_started{0};
+static bool loader_ok = false;
+/** Number of queued jobs, released once more without a job to stop the loader thread. */
+static std::counting_semaphore<> loader_jobs_queued{0};
+/** Guards loader_pending and loader_completed. */
+static std::mutex loader_mtx;
+static std::deque<gl_upload_t> loader_pending;
+/** Jobs executed by the loader thread in submission order, awaiting their fence. */
+static std::vector<completed_upload_t> loader_completed;
+/** Rendering thread only, reused to invoke ready callbacks outside of the lock. */
+static std::vector<completed_upload_t> loader_ready;
+
+/** GL_APPLE_sync on ES2 and core on ES3 share their signatures and enum values. */
+static PFNGLFENCESYNCAPPLEPROC glFenceSync_ = nullptr;
+static PFNGLCLIENTWAITSYNCAPPLEPROC glClientWaitSync_ = nullptr;
+static PFNGLDELETESYNCAPPLEPROC glDeleteSync_ = nullptr;
+
+/** Returns the GL function of given name with APPLE suffix, or its core name. */
+static void* get_sync_proc(const char* core_name, bool apple) noexcept {
+    if (apple) {
+        const std::string apple_name = std::string(core_name) + "APPLE";
+        return impl::get_gl_proc_address(apple_name.c_str());
+    }
+    return impl::get_gl_proc_address(core_name);
+}
+
+static void init_fence_procs() noexcept {
+    glFenceSync_ = nullptr;
+    glClientWaitSync_ = nullptr;
+    glDeleteSync_ = nullptr;
+    if (!gl_caps.fence_sync) {
+        return;
+    }
+    const bool core = gl_caps.es3;
+    glFenceSync_ = reinterpret_cast<PFNGLFENCESYNCAPPLEPROC>(get_sync_proc("glFenceSync", !core));
+    glClientWaitSync_ = reinterpret_cast<PFNGLCLIENTWAITSYNCAPPLEPROC>(get_sync_proc("glClientWaitSync", !core));
+    glDeleteSync_ = reinterpret_cast<PFNGLDELETESYNCAPPLEPROC>(get_sync_proc("glDeleteSync", !core));
+    if (nullptr == glFenceSync_ || nullptr == glClientWaitSync_ || nullptr == glDeleteSync_) {
+        glFenceSync_ = nullptr;
+    }
+}
+
+static void loader_thread_main() noexcept {
+    loader_ok = impl::make_shared_gl_context_current(loader_glc, true);
+    loader_started.release();
+    if (!loader_ok) {
+        log_printf(log_level_t::error, "GL loader: Error acquiring GL context\n");
+        return;
+    }
+    while (true) {
+        loader_jobs_queued.acquire();
+        gl_upload_t job;
+        {
+            std::lock_guard<std::mutex> lock(loader_mtx);
+            if (loader_pending.empty()) {
+                break;  // stop requested, all jobs executed
+            }
+            job = loader_pending.front();
+            loader_pending.pop_front();
+        }
+        bool ok;
+        GLsync sync = nullptr;
+        {
+            GAMP_PROFILE_ZONE("gl_upload");
+            ok = job.upload(job.data);
+            if (nullptr != glFenceSync_) {
+                sync = glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0);
+                glFlush();  // makes the fence visible to the rendering context
+            }
+            if (nullptr == sync) {
+                glFinish();
+            }
+        }
+        std::lock_guard<std::mutex> lock(loader_mtx);
+        loader_completed.push_back({job, ok, sync});
+    }
+    {
+        // Completes all uploads and deletes the fences not yet polled while this context is current
+        glFinish();
+        std::lock_guard<std::mutex> lock(loader_mtx);
+        for (completed_upload_t& c : loader_completed) {
+            if (nullptr != c.sync) {
+                glDeleteSync_(c.sync);
+                c.sync = nullptr;
+            }
+        }
+    }
+    impl::make_shared_gl_context_current(loader_glc, false);
+}
+
+bool gamp::has_gl_loader() noexcept {
+    return loader_running.load(std::memory_order_acquire);
+}
+
+bool gamp::start_gl_loader() noexcept {
+#if defined(__EMSCRIPTEN__)
+    log_printf(log_level_t::error, "GL loader: Not supported on WebAssembly\n");
+    return false;
+#else
+    if (has_gl_loader()) {
+        return true;
+    }
+    if (!impl::create_shared_gl_context(loader_glc)) {
+        return false;
+    }
+    init_fence_procs();
+    loader_running.store(true, std::memory_order_release);
+    loader_thread = std::thread(loader_thread_main);
+    loader_started.acquire();
+    if (!loader_ok) {
+        loader_thread.join();
+        loader_running.store(false, std::memory_order_release);
+        impl::destroy_shared_gl_context(loader_glc);
+        return false;
+    }
+    log_printf(log_level_t::info, "GL loader: Started, %s\n", nullptr != glFenceSync_ ? "fence sync" : "finish");
+    return true;
+#endif
+}
+
+void gamp::stop_gl_loader() noexcept {
+    if (!has_gl_loader()) {
+        return;
+    }
+    if (impl::render_thread_active()) {
+        log_printf(log_level_t::error, "GL loader: Error stopping while the render thread is running\n");
+        return;
+    }
+    loader_running.store(false, std::memory_order_release);
+    loader_jobs_queued.release();
+    loader_thread.join();
+    impl::destroy_shared_gl_context(loader_glc);
+    // Completed uploads are complete on the GPU, jobs submitted concurrently to stopping have not been executed
+    loader_ready.clear();
+    {
+        std::lock_guard<std::mutex> lock(loader_mtx);
+        loader_ready.swap(loader_completed);
+        for (const gl_upload_t& job : loader_pending) {
+            loader_ready.push_back({job, false, nullptr});
+        }
+        loader_pending.clear();
+    }
+    for (const completed_upload_t& c : loader_ready) {
+        if (nullptr != c.job.ready) {
+            c.job.ready(c.job.data, c.ok);
+        }
+    }
+    loader_ready.clear();
+    log_printf(log_level_t::info, "GL loader: Stopped\n");
+}
+
+bool gamp::submit_gl_upload(const gl_upload_t& job) noexcept {
+    if (!has_gl_loader() || nullptr == job.upload) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(loader_mtx);
+        loader_pending.push_back(job);
+    }
+    loader_jobs_queued.release();
+    return true;
+}
+
+size_t gamp::poll_gl_uploads() noexcept {
+    loader_ready.clear();
+    {
+        std::lock_guard<std::mutex> lock(loader_mtx);
+        size_t n = 0;
+        for (; n < loader_completed.size(); ++n) {
+            const completed_upload_t& c = loader_completed[n];
+            if (nullptr != c.sync) {
+                const GLenum r = glClientWaitSync_(c.sync, 0, 0);
+                if (GL_TIMEOUT_EXPIRED_APPLE == r) {
+                    break;  // keep submission order
+                }
+                glDeleteSync_(c.sync);  // signaled, or failed with the objects being unusable anyways
+            }
+        }
+        loader_ready.assign(loader_completed.begin(), loader_completed.begin() + static_cast<ptrdiff_t>(n));
+        loader_completed.erase(loader_completed.begin(), loader_completed.begin() + static_cast<ptrdiff_t>(n));
+    }
+    for (const completed_upload_t& c : loader_ready) {
+        if (nullptr != c.job.ready) {
+            c.job.ready(c.job.data, c.ok);
+        }
+    }
+    return loader_ready.size();
+}
@@ -0,0 +1,160 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+using namespace gamp;
+
+/**
+ * Number of timer queries in flight, i.e. results are read back up to N-1 frames late.
+ * If all are pending, the next frame is not measured instead of stalling the pipeline.
+ */
+static constexpr size_t gpu_query_count = 4;
+
+static bool gpu_timer_avail = false;
+/** Only GL_EXT_disjoint_timer_query reports disjoint operations, e.g. GPU frequency changes. */
+static bool gpu_timer_disjoint_avail = false;
+static GLuint gpu_queries[gpu_query_count];
+static size_t gpu_query_oldest = 0;
+static size_t gpu_query_pending = 0;
+static bool gpu_query_active = false;
+
+static PFNGLGENQUERIESEXTPROC glGenQueries_ = nullptr;
+static PFNGLBEGINQUERYEXTPROC glBeginQuery_ = nullptr;
+static PFNGLENDQUERYEXTPROC glEndQuery_ = nullptr;
+static PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuiv_ = nullptr;
+static PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64v_ = nullptr;
+
+static duration_histogram_t gpu_time_histogram;
+static uint64_t gpu_time_sum_us = 0;
+static uint64_t gpu_time_over_budget = 0;
+
+/** Returns the GL function of given name with EXT suffix, or its core name as fallback. */
+static void* get_query_proc(const char* core_name, bool ext) noexcept {
+    if (ext) {
+        const std::string ext_name = std::string(core_name) + "EXT";
+        void* f = impl::get_gl_proc_address(ext_name.c_str());
+        if (nullptr != f) {
+            return f;
+        }
+    }
+    return impl::get_gl_proc_address(core_name);
+}
+
+bool impl::gpu_timer_init() noexcept {
+    gpu_timer_avail = false;
+    gpu_query_oldest = 0;
+    gpu_query_pending = 0;
+    gpu_query_active = false;
+    gpu_time_histogram.clear();
+    gpu_time_sum_us = 0;
+    gpu_time_over_budget = 0;
+
+    const bool ext = gl_caps.has(gl_ext_t::EXT_disjoint_timer_query) || gl_caps.has(gl_ext_t::EXT_disjoint_timer_query_webgl2);
+    const bool arb = !ext && gl_caps.has(gl_ext_t::ARB_timer_query);
+    if (!ext && !arb) {
+        printf("GPU timer query: n/a\n");
+        return false;
+    }
+    glGenQueries_ = reinterpret_cast<PFNGLGENQUERIESEXTPROC>(get_query_proc("glGenQueries", ext));
+    glBeginQuery_ = reinterpret_cast<PFNGLBEGINQUERYEXTPROC>(get_query_proc("glBeginQuery", ext));
+    glEndQuery_ = reinterpret_cast<PFNGLENDQUERYEXTPROC>(get_query_proc("glEndQuery", ext));
+    glGetQueryObjectuiv_ = reinterpret_cast<PFNGLGETQUERYOBJECTUIVEXTPROC>(get_query_proc("glGetQueryObjectuiv", ext));
+    glGetQueryObjectui64v_ = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(get_query_proc("glGetQueryObjectui64v", ext));
+    if (nullptr == glGenQueries_ || nullptr == glBeginQuery_ || nullptr == glEndQuery_ ||
+        nullptr == glGetQueryObjectuiv_ || nullptr == glGetQueryObjectui64v_) {
+        printf("GPU timer query: n/a, missing functions\n");
+        return false;
+    }
+    glGenQueries_(gpu_query_count, gpu_queries);
+    gpu_timer_disjoint_avail = ext;
+    gpu_timer_avail = true;
+    printf("GPU timer query: %s, %zu queries in flight\n", ext ? "EXT_disjoint_timer_query" : "ARB_timer_query", gpu_query_count);
+    return true;
+}
+
+void impl::gpu_timer_end_frame() noexcept {
+    if (gpu_query_active) {
+        glEndQuery_(GL_TIME_ELAPSED_EXT);
+        gpu_query_active = false;
+        ++gpu_query_pending;
+    }
+}
+
+uint64_t impl::gpu_timer_begin_frame(int budget_fps) noexcept {
+    if (!gpu_timer_avail) {
+        return 0;
+    }
+    uint64_t max_us = 0;
+    bool disjoint = false;
+    if (gpu_timer_disjoint_avail && 0 < gpu_query_pending) {
+        GLint v = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &v);  // also clears the disjoint state
+        disjoint = 0 != v;
+    }
+    while (0 < gpu_query_pending) {
+        const GLuint q = gpu_queries[gpu_query_oldest];
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv_(q, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+        if (GL_FALSE == available) {
+            break;
+        }
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v_(q, GL_QUERY_RESULT_EXT, &ns);
+        gpu_query_oldest = (gpu_query_oldest + 1) % gpu_query_count;
+        --gpu_query_pending;
+        if (!disjoint) {
+            const uint64_t us = ns / 1000;
+            max_us = std::max(max_us, us);
+            gpu_time_histogram.add(us);
+            gpu_time_sum_us += us;
+            if (0 < budget_fps && us * static_cast<uint64_t>(budget_fps) > 1000000) {
+                ++gpu_time_over_budget;
+            }
+        }
+    }
+    if (gpu_query_pending < gpu_query_count) {
+        glBeginQuery_(GL_TIME_ELAPSED_EXT, gpu_queries[(gpu_query_oldest + gpu_query_pending) % gpu_query_count]);
+        gpu_query_active = true;
+    }
+    return max_us;
+}
+
+void impl::gpu_timer_end_period(double& gpu_costs, duration_percentiles_t& gpu_pct) noexcept {
+    const uint64_t n = gpu_time_histogram.count();
+    gpu_costs = 0 < n ? static_cast<double>(gpu_time_sum_us) / static_cast<double>(n) / 1000000.0 : 0.0;
+    gpu_pct = gpu_time_histogram.percentiles(gpu_time_over_budget);
+    gpu_time_histogram.clear();
+    gpu_time_sum_us = 0;
+    gpu_time_over_budget = 0;
+}
+
+bool gamp::has_gpu_timer_query() noexcept {
+    return gpu_timer_avail;
+}
@@ -0,0 +1,241 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+using namespace gamp;
+
+/**
+ * Recording file layout, all values little endian:
+ * - header: magic `GAMPREC` and version byte
+ * - records of record_size bytes followed by their text bytes, see write_record(), a record of type NONE marks the end of a frame
+ */
+static constexpr char rec_magic[8] = { 'G', 'A', 'M', 'P', 'R', 'E', 'C', 4 };
+static constexpr size_t record_size = 42;
+static constexpr size_t record_text_max = sizeof(event_t::text) - 1;
+
+static FILE* rec_file = nullptr;
+static int64_t rec_t0_ns = 0;
+static uint64_t rec_count = 0;
+
+static FILE* rep_file = nullptr;
+static replay_mode_t rep_mode = replay_mode_t::realtime;
+static int64_t rep_t0_ns = 0;
+static uint64_t rep_count = 0;
+/** Lookahead record, valid if rep_has_next. */
+static event_t rep_next;
+static int64_t rep_next_ns = 0;
+static bool rep_has_next = false;
+/** Fast mode: true if the current frame's events have been replayed, until input_record_end_frame(). */
+static bool rep_frame_done = false;
+
+static int64_t to_ns(const jau::fraction_timespec& t) noexcept {
+    return t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+static void put_le(uint8_t*& p, uint64_t v, size_t bytes) noexcept {
+    for (size_t i = 0; i < bytes; ++i) {
+        *p++ = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+static uint64_t get_le(const uint8_t*& p, size_t bytes) noexcept {
+    uint64_t v = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        v |= static_cast<uint64_t>(*p++) << (8 * i);
+    }
+    return v;
+}
+
+/** Record: t_ns i64, type u16, action u16, key_code u16, pointer_type u8, button u8, down u8, id i32, x i32, y i32, dx i32, dy i32, pressure f32, text_len u8, text. */
+static bool write_record(const event_t& e, int64_t t_ns) noexcept {
+    uint8_t buf[record_size + record_text_max];
+    uint8_t* p = buf;
+    uint32_t pressure;
+    std::memcpy(&pressure, &e.pressure, sizeof(pressure));
+    put_le(p, static_cast<uint64_t>(t_ns), 8);
+    put_le(p, static_cast<uint16_t>(e.type), 2);
+    put_le(p, static_cast<uint16_t>(e.action), 2);
+    put_le(p, e.key_code, 2);
+    put_le(p, static_cast<uint8_t>(e.pointer_type), 1);
+    put_le(p, e.button, 1);
+    put_le(p, e.down ? 1 : 0, 1);
+    put_le(p, static_cast<uint32_t>(e.id), 4);
+    put_le(p, static_cast<uint32_t>(e.x), 4);
+    put_le(p, static_cast<uint32_t>(e.y), 4);
+    put_le(p, static_cast<uint32_t>(e.dx), 4);
+    put_le(p, static_cast<uint32_t>(e.dy), 4);
+    put_le(p, pressure, 4);
+    const std::string_view text = e.text_view();
+    const size_t text_len = std::min(text.size(), record_text_max);
+    put_le(p, text_len, 1);
+    std::memcpy(p, text.data(), text_len);
+    return 1 == fwrite(buf, record_size + text_len, 1, rec_file);
+}
+
+static bool read_record(event_t& e, int64_t& t_ns) noexcept {
+    uint8_t buf[record_size];
+    if (1 != fread(buf, sizeof(buf), 1, rep_file)) {
+        return false;
+    }
+    const uint8_t* p = buf;
+    e = event_t();
+    t_ns = static_cast<int64_t>(get_le(p, 8));
+    e.type = static_cast<input_event_type_t>(get_le(p, 2));
+    e.action = static_cast<input_event_type_t>(get_le(p, 2));
+    e.key_code = static_cast<uint16_t>(get_le(p, 2));
+    e.pointer_type = static_cast<pointer_type_t>(get_le(p, 1));
+    e.button = static_cast<uint8_t>(get_le(p, 1));
+    e.down = 0 != get_le(p, 1);
+    e.id = static_cast<int32_t>(static_cast<uint32_t>(get_le(p, 4)));
+    e.x = static_cast<int32_t>(static_cast<uint32_t>(get_le(p, 4)));
+    e.y = static_cast<int32_t>(static_cast<uint32_t>(get_le(p, 4)));
+    e.dx = static_cast<int32_t>(static_cast<uint32_t>(get_le(p, 4)));
+    e.dy = static_cast<int32_t>(static_cast<uint32_t>(get_le(p, 4)));
+    const uint32_t pressure = static_cast<uint32_t>(get_le(p, 4));
+    std::memcpy(&e.pressure, &pressure, sizeof(pressure));
+    const size_t text_len = std::min<size_t>(get_le(p, 1), record_text_max);  // e.text remains zero terminated
+    return 0 == text_len || 1 == fread(e.text.data(), text_len, 1, rep_file);
+}
+
+bool gamp::start_input_recording(const std::string& path) noexcept {
+    stop_input_recording();
+    rec_file = fopen(path.c_str(), "wb");
+    if (nullptr == rec_file) {
+        printf("Input recording: Error opening %s\n", path.c_str());
+        return false;
+    }
+    if (1 != fwrite(rec_magic, sizeof(rec_magic), 1, rec_file)) {
+        printf("Input recording: Error writing %s\n", path.c_str());
+        fclose(rec_file);
+        rec_file = nullptr;
+        return false;
+    }
+    rec_t0_ns = to_ns(jau::getMonotonicTime());
+    rec_count = 0;
+    printf("Input recording: %s\n", path.c_str());
+    return true;
+}
+
+void gamp::stop_input_recording() noexcept {
+    if (nullptr != rec_file) {
+        if (0 != fclose(rec_file)) {
+            printf("Input recording: Error closing file\n");
+        }
+        rec_file = nullptr;
+        printf("Input recording: Stopped, %" PRIu64 " events\n", rec_count);
+    }
+}
+
+void impl::input_record(const event_t& e) noexcept {
+    if (nullptr == rec_file || input_event_type_t::NONE == e.type) {
+        return;
+    }
+    if (!write_record(e, to_ns(e.timestamp) - rec_t0_ns)) {
+        printf("Input recording: Error writing event, stopping\n");
+        stop_input_recording();
+        return;
+    }
+    ++rec_count;
+}
+
+void impl::input_record_end_frame() noexcept {
+    if (nullptr != rec_file && !write_record(event_t(), to_ns(jau::getMonotonicTime()) - rec_t0_ns)) {
+        printf("Input recording: Error writing frame marker, stopping\n");
+        stop_input_recording();
+    }
+    rep_frame_done = false;
+}
+
+bool gamp::start_input_replay(const std::string& path, replay_mode_t mode) noexcept {
+    stop_input_replay();
+    rep_file = fopen(path.c_str(), "rb");
+    if (nullptr == rep_file) {
+        printf("Input replay: Error opening %s\n", path.c_str());
+        return false;
+    }
+    char magic[sizeof(rec_magic)];
+    if (1 != fread(magic, sizeof(magic), 1, rep_file) || 0 != std::memcmp(magic, rec_magic, sizeof(magic))) {
+        printf("Input replay: Not a recording %s\n", path.c_str());
+        fclose(rep_file);
+        rep_file = nullptr;
+        return false;
+    }
+    rep_mode = mode;
+    rep_t0_ns = to_ns(jau::getMonotonicTime());
+    rep_count = 0;
+    rep_frame_done = false;
+    rep_has_next = read_record(rep_next, rep_next_ns);
+    printf("Input replay: %s, %s\n", path.c_str(), replay_mode_t::fast == mode ? "fast" : "realtime");
+    return true;
+}
+
+void gamp::stop_input_replay() noexcept {
+    if (nullptr != rep_file) {
+        fclose(rep_file);
+        rep_file = nullptr;
+        rep_has_next = false;
+        printf("Input replay: Stopped, %" PRIu64 " events\n", rep_count);
+    }
+}
+
+bool gamp::is_input_replaying() noexcept {
+    return nullptr != rep_file;
+}
+
+bool impl::input_replay_active() noexcept {
+    return nullptr != rep_file;
+}
+
+size_t impl::input_replay_poll(std::span<event_t> events) noexcept {
+    size_t count = 0;
+    const jau::fraction_timespec now = jau::getMonotonicTime();
+    const int64_t elapsed_ns = to_ns(now) - rep_t0_ns;
+    while (rep_has_next && count < events.size()) {
+        const bool marker = input_event_type_t::NONE == rep_next.type;
+        if (replay_mode_t::fast == rep_mode) {
+            if (rep_frame_done) {
+                break;
+            }
+            rep_frame_done = marker;
+        } else if (rep_next_ns > elapsed_ns) {
+            break;
+        }
+        if (!marker && input_event_type_t::WINDOW_RESIZED != rep_next.type) {
+            events[count] = rep_next;
+            events[count].timestamp = now;
+            ++count;
+            ++rep_count;
+        }
+        rep_has_next = read_record(rep_next, rep_next_ns);
+    }
+    if (!rep_has_next) {
+        printf("Input replay: Finished\n");
+        stop_input_replay();
+    }
+    return count;
+}
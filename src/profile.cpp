@@ -0,0 +1,131 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <gamp/profile.hpp>
+#include <gamp/spsc_ring.hpp>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace gamp;
+
+namespace {
+    struct record_t {
+        const char* name = nullptr;
+        int64_t t0_ns = 0;
+        /** End of zone, or -1 for an instant frame marker */
+        int64_t t1_ns = 0;
+    };
+
+    struct thread_buffer_t {
+        int tid;
+        spsc_ring_t<record_t, profile::records_per_thread> ring;
+
+        explicit thread_buffer_t(int tid_) noexcept : tid(tid_) {}
+    };
+
+    /** Guards registration of thread_buffer_t and their consumption by write_chrome_trace(). */
+    std::mutex buffers_mtx;
+    /** Registered thread buffers, kept alive after their thread ended until process exit. */
+    std::vector<std::unique_ptr<thread_buffer_t>> buffers;
+    std::atomic<uint64_t> dropped{0};
+    thread_local thread_buffer_t* this_buffer = nullptr;
+
+    thread_buffer_t& get_buffer() noexcept {
+        if (nullptr == this_buffer) {
+            const std::lock_guard<std::mutex> lock(buffers_mtx);
+            buffers.push_back(std::make_unique<thread_buffer_t>(static_cast<int>(buffers.size()) + 1));
+            this_buffer = buffers.back().get();
+        }
+        return *this_buffer;
+    }
+
+    void push(const record_t& r) noexcept {
+        if (!get_buffer().ring.push(r)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void write_json_string(FILE* out, const char* s) noexcept {
+        fputc('"', out);
+        for (; nullptr != s && '\0' != *s; ++s) {
+            if ('"' == *s || '\\' == *s) {
+                fputc('\\', out);
+            }
+            fputc(*s, out);
+        }
+        fputc('"', out);
+    }
+}  // namespace
+
+void profile::record_zone(const char* name, int64_t t0_ns, int64_t t1_ns) noexcept {
+    push(record_t{name, t0_ns, t1_ns});
+}
+
+void profile::frame_mark(const char* name) noexcept {
+    push(record_t{name, now_ns(), -1});
+}
+
+uint64_t profile::dropped_records() noexcept {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+bool profile::write_chrome_trace(const std::string& path) noexcept {
+    FILE* out = fopen(path.c_str(), "w");
+    if (nullptr == out) {
+        printf("Profile: Error opening trace file %s\n", path.c_str());
+        return false;
+    }
+    const std::lock_guard<std::mutex> lock(buffers_mtx);
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    bool first = true;
+    for (const std::unique_ptr<thread_buffer_t>& b : buffers) {
+        record_t r;
+        while (b->ring.pop(r)) {
+            if (!first) {
+                fputs(",\n", out);
+            }
+            first = false;
+            fputs("{\"name\":", out);
+            write_json_string(out, r.name);
+            if (0 > r.t1_ns) {
+                fprintf(out, ",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                        static_cast<double>(r.t0_ns) / 1000.0, b->tid);
+            } else {
+                fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                        static_cast<double>(r.t0_ns) / 1000.0, static_cast<double>(r.t1_ns - r.t0_ns) / 1000.0, b->tid);
+            }
+        }
+    }
+    fputs("\n]}\n", out);
+    const bool ok = 0 == ferror(out);
+    if (0 != fclose(out) || !ok) {
+        printf("Profile: Error writing trace file %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
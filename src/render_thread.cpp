@@ -0,0 +1,139 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <gamp/spsc_ring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <semaphore>
+#include <thread>
+
+using namespace gamp;
+
+typedef std::counting_semaphore<render_queue_capacity> render_semaphore_t;
+
+static spsc_ring_t<render_frame_t, render_queue_capacity> render_queue;
+/** Number of queued frames, released once more without a frame to stop the render thread. */
+static std::unique_ptr<render_semaphore_t> render_frames_queued;
+/** Number of frames which may be submitted until max_frames_in_flight is reached, released after presenting a frame. */
+static std::unique_ptr<render_semaphore_t> render_slots_free;
+static std::thread render_thread;
+/** Written by the event thread only while the render thread is not running. */
+static std::atomic<bool> render_thread_running{false};
+/** Released by the render thread once it has acquired the GL context or failed, see render_thread_ok. */
+static std::binary_semaphore render_thread_started{0};
+static bool render_thread_ok = false;
+
+static void render_thread_main() noexcept {
+    render_thread_ok = impl::make_gl_context_current(true);
+    render_thread_started.release();
+    if (!render_thread_ok) {
+        log_printf(log_level_t::error, "Render thread: Error acquiring GL context\n");
+        return;
+    }
+    render_frame_t frame;
+    while (true) {
+        render_frames_queued->acquire();
+        if (!render_queue.pop(frame)) {
+            break;  // stop requested, all frames rendered
+        }
+        {
+            GAMP_PROFILE_ZONE("render_frame");
+            impl::apply_resize(frame.resize);
+            frame.invoke(frame);
+        }
+        impl::present_frame(frame.fps, frame.input_t0_ns);
+        render_slots_free->release();
+    }
+    impl::make_gl_context_current(false);
+}
+
+bool impl::render_thread_active() noexcept {
+    return render_thread_running.load(std::memory_order_acquire);
+}
+
+bool gamp::has_render_thread() noexcept {
+    return render_thread_running.load(std::memory_order_acquire);
+}
+
+bool gamp::start_render_thread(size_t max_frames_in_flight) noexcept {
+#if defined(__EMSCRIPTEN__)
+    (void)max_frames_in_flight;
+    log_printf(log_level_t::error, "Render thread: Not supported on WebAssembly\n");
+    return false;
+#else
+    if (has_render_thread()) {
+        return true;
+    }
+    const ptrdiff_t n = static_cast<ptrdiff_t>(std::clamp<size_t>(max_frames_in_flight, 1, render_queue_capacity));
+    render_frames_queued = std::make_unique<render_semaphore_t>(0);
+    render_slots_free = std::make_unique<render_semaphore_t>(n);
+    if (!impl::make_gl_context_current(false)) {
+        return false;
+    }
+    render_thread_running.store(true, std::memory_order_release);
+    render_thread = std::thread(render_thread_main);
+    render_thread_started.acquire();
+    if (!render_thread_ok) {
+        render_thread.join();
+        render_thread_running.store(false, std::memory_order_release);
+        impl::make_gl_context_current(true);
+        return false;
+    }
+    log_printf(log_level_t::info, "Render thread: Started, %td frames in flight\n", n);
+    return true;
+#endif
+}
+
+void gamp::stop_render_thread() noexcept {
+    if (!has_render_thread()) {
+        return;
+    }
+    render_frames_queued->release();
+    render_thread.join();
+    render_thread_running.store(false, std::memory_order_release);
+    impl::make_gl_context_current(true);
+    impl::apply_resize(impl::take_pending_resize());  // not yet submitted with a frame
+    log_printf(log_level_t::info, "Render thread: Stopped\n");
+}
+
+bool gamp::submit_render_frame(const render_frame_t& frame) noexcept {
+    if (!has_render_thread()) {
+        return false;
+    }
+    {
+        GAMP_PROFILE_ZONE("submit_render_frame");
+        render_slots_free->acquire();  // bounds the frames in flight
+    }
+    impl::input_record_end_frame();
+    render_frame_t f = frame;
+    f.input_t0_ns = impl::take_input_latency_t0();  // input handled before building this frame
+    f.resize = impl::take_pending_resize();
+    render_queue.push(f);  // never full, bounded by render_slots_free
+    render_frames_queued->release();
+    return true;
+}
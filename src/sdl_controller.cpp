@@ -0,0 +1,221 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+#include <SDL2/SDL.h>
+
+using namespace gamp;
+
+static_assert(controller_axis_count == SDL_CONTROLLER_AXIS_MAX);
+static_assert(static_cast<int>(controller_button_t::dpad_right) == SDL_CONTROLLER_BUTTON_DPAD_RIGHT);
+
+static constexpr size_t ctrl_capacity = controller_snapshot_t::capacity;
+/** Number of buttons polled, i.e. up to and including controller_button_t::dpad_right. */
+static constexpr int ctrl_button_count = SDL_CONTROLLER_BUTTON_DPAD_RIGHT + 1;
+
+static bool ctrl_initialized = false;
+/** Set by the event thread on controller hotplug, triggering a rescan by poll_controllers(). */
+static std::atomic<bool> ctrl_rescan{false};
+static std::array<SDL_GameController*, ctrl_capacity> ctrl_handles{};
+static std::array<SDL_JoystickID, ctrl_capacity> ctrl_ids{};
+static controller_snapshot_t ctrl_snapshot;
+/** Previous digital state per slot, see digital_state(). */
+static std::array<uint32_t, ctrl_capacity> ctrl_digital_prev{};
+static float ctrl_stick_deadzone = 0.15f;
+static float ctrl_trigger_deadzone = 0.05f;
+
+/** Logical digital inputs of a controller, bit numbers of digital_state(). */
+enum digital_t : uint32_t { dig_up, dig_down, dig_right, dig_left, dig_action1, dig_action2, dig_action3, dig_pause, dig_reset, dig_count };
+
+static constexpr std::array<std::array<input_event_type_t, dig_count>, 2> digital_actions = {{
+    { input_event_type_t::P1_UP, input_event_type_t::P1_DOWN, input_event_type_t::P1_RIGHT, input_event_type_t::P1_LEFT,
+      input_event_type_t::P1_ACTION1, input_event_type_t::P1_ACTION2, input_event_type_t::P1_ACTION3,
+      input_event_type_t::PAUSE, input_event_type_t::RESET },
+    { input_event_type_t::P2_UP, input_event_type_t::P2_DOWN, input_event_type_t::P2_RIGHT, input_event_type_t::P2_LEFT,
+      input_event_type_t::P2_ACTION1, input_event_type_t::P2_ACTION2, input_event_type_t::P2_ACTION3,
+      input_event_type_t::PAUSE, input_event_type_t::RESET }
+}};
+
+void impl::on_controller_hotplug() noexcept {
+    ctrl_rescan.store(true, std::memory_order_release);
+}
+
+static void close_slot(size_t i) noexcept {
+    printf("Controller %zu disconnected\n", i);
+    SDL_GameControllerClose(ctrl_handles[i]);
+    ctrl_handles[i] = nullptr;
+    ctrl_snapshot.connected[i] = false;
+    ctrl_snapshot.buttons[i] = 0;
+    for (std::array<float, ctrl_capacity>& a : ctrl_snapshot.axes) {
+        a[i] = 0.0f;
+    }
+}
+
+/** Closes detached controllers and opens newly attached ones into free slots. */
+static void rescan_controllers() noexcept {
+    for (size_t i = 0; i < ctrl_capacity; ++i) {
+        if (nullptr != ctrl_handles[i] && SDL_TRUE != SDL_GameControllerGetAttached(ctrl_handles[i])) {
+            close_slot(i);
+        }
+    }
+    const int n = SDL_NumJoysticks();
+    for (int d = 0; d < n; ++d) {
+        if (SDL_TRUE != SDL_IsGameController(d)) {
+            continue;
+        }
+        const SDL_JoystickID id = SDL_JoystickGetDeviceInstanceID(d);
+        size_t free_slot = ctrl_capacity;
+        bool open = false;
+        for (size_t i = 0; i < ctrl_capacity; ++i) {
+            if (nullptr != ctrl_handles[i]) {
+                open = open || ctrl_ids[i] == id;
+            } else if (ctrl_capacity == free_slot) {
+                free_slot = i;
+            }
+        }
+        if (open || ctrl_capacity == free_slot) {
+            continue;
+        }
+        SDL_GameController* gc = SDL_GameControllerOpen(d);
+        if (nullptr == gc) {
+            printf("Controller: Error opening device %d: %s\n", d, SDL_GetError());
+            continue;
+        }
+        ctrl_handles[free_slot] = gc;
+        ctrl_ids[free_slot] = id;
+        ctrl_snapshot.connected[free_slot] = true;
+        ctrl_digital_prev[free_slot] = 0;
+        printf("Controller %zu connected: %s\n", free_slot, SDL_GameControllerName(gc));
+    }
+}
+
+bool gamp::init_controller_subsystem() noexcept {
+    if (ctrl_initialized) {
+        return true;
+    }
+    if (0 != SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER)) {
+        printf("SDL: Error initializing game controller: %s\n", SDL_GetError());
+        return false;
+    }
+    // State is polled per frame, keep hotplug events only
+    for (const Uint32 type : { SDL_CONTROLLERAXISMOTION, SDL_CONTROLLERBUTTONDOWN, SDL_CONTROLLERBUTTONUP,
+                               SDL_JOYAXISMOTION, SDL_JOYBALLMOTION, SDL_JOYHATMOTION, SDL_JOYBUTTONDOWN, SDL_JOYBUTTONUP }) {
+        SDL_EventState(type, SDL_IGNORE);
+    }
+    ctrl_initialized = true;
+    rescan_controllers();
+    return true;
+}
+
+void gamp::set_controller_deadzone(float stick, float trigger) noexcept {
+    ctrl_stick_deadzone = std::clamp(stick, 0.0f, 0.99f);
+    ctrl_trigger_deadzone = std::clamp(trigger, 0.0f, 0.99f);
+}
+
+/** Batch deadzone pass over all slots, radial for stick pairs and rescaling the remaining range to [0..1]. */
+static void apply_deadzones() noexcept {
+    std::array<std::array<float, ctrl_capacity>, controller_axis_count>& axes = ctrl_snapshot.axes;
+    const float sdz = ctrl_stick_deadzone, sscale = 1.0f / (1.0f - sdz);
+    for (size_t s = 0; s < 2; ++s) {
+        std::array<float, ctrl_capacity>& xs = axes[2 * s];
+        std::array<float, ctrl_capacity>& ys = axes[2 * s + 1];
+        for (size_t i = 0; i < ctrl_capacity; ++i) {
+            const float mag = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+            const float f = mag > sdz ? std::min(1.0f, (mag - sdz) * sscale) / mag : 0.0f;
+            xs[i] *= f;
+            ys[i] *= f;
+        }
+    }
+    const float tdz = ctrl_trigger_deadzone, tscale = 1.0f / (1.0f - tdz);
+    for (size_t t = static_cast<size_t>(controller_axis_t::trigger_left); t < controller_axis_count; ++t) {
+        for (float& v : axes[t]) {
+            v = std::max(0.0f, v - tdz) * tscale;
+        }
+    }
+}
+
+/** Returns the logical digital state of given slot, see digital_t. */
+static uint32_t digital_state(size_t i) noexcept {
+    constexpr float stick_threshold = 0.5f;
+    const uint32_t b = ctrl_snapshot.buttons[i];
+    const float x = ctrl_snapshot.axis(i, controller_axis_t::left_x);
+    const float y = ctrl_snapshot.axis(i, controller_axis_t::left_y);
+    uint32_t d = 0;
+    d |= ( 0 != (b & bitmask(controller_button_t::dpad_up)) || y < -stick_threshold ) ? 1U << dig_up : 0;
+    d |= ( 0 != (b & bitmask(controller_button_t::dpad_down)) || y > stick_threshold ) ? 1U << dig_down : 0;
+    d |= ( 0 != (b & bitmask(controller_button_t::dpad_right)) || x > stick_threshold ) ? 1U << dig_right : 0;
+    d |= ( 0 != (b & bitmask(controller_button_t::dpad_left)) || x < -stick_threshold ) ? 1U << dig_left : 0;
+    d |= 0 != (b & bitmask(controller_button_t::a)) ? 1U << dig_action1 : 0;
+    d |= 0 != (b & bitmask(controller_button_t::b)) ? 1U << dig_action2 : 0;
+    d |= 0 != (b & bitmask(controller_button_t::x)) ? 1U << dig_action3 : 0;
+    d |= 0 != (b & bitmask(controller_button_t::start)) ? 1U << dig_pause : 0;
+    d |= 0 != (b & bitmask(controller_button_t::back)) ? 1U << dig_reset : 0;
+    return d;
+}
+
+const controller_snapshot_t& gamp::poll_controllers(input_event_t& event) noexcept {
+    if (!ctrl_initialized) {
+        return ctrl_snapshot;
+    }
+    GAMP_PROFILE_ZONE("poll_controllers");
+    SDL_GameControllerUpdate();  // required with disabled controller events
+    if (ctrl_rescan.exchange(false, std::memory_order_acquire)) {
+        rescan_controllers();
+    }
+    for (size_t i = 0; i < ctrl_capacity; ++i) {
+        SDL_GameController* gc = ctrl_handles[i];
+        if (nullptr == gc) {
+            continue;
+        }
+        for (size_t a = 0; a < controller_axis_count; ++a) {
+            ctrl_snapshot.axes[a][i] = static_cast<float>(SDL_GameControllerGetAxis(gc, static_cast<SDL_GameControllerAxis>(a))) / 32767.0f;
+        }
+        uint32_t buttons = 0;
+        for (int b = 0; b < ctrl_button_count; ++b) {
+            buttons |= 0 != SDL_GameControllerGetButton(gc, static_cast<SDL_GameControllerButton>(b)) ? 1U << b : 0;
+        }
+        ctrl_snapshot.buttons[i] = buttons;
+    }
+    apply_deadzones();
+    for (size_t i = 0; i < digital_actions.size(); ++i) {
+        const uint32_t d = ctrl_snapshot.connected[i] ? digital_state(i) : 0;
+        const uint32_t changed = d ^ ctrl_digital_prev[i];
+        ctrl_digital_prev[i] = d;
+        for (uint32_t bit = 0; 0 != changed && bit < dig_count; ++bit) {
+            if (0 != (changed & (1U << bit))) {
+                if (0 != (d & (1U << bit))) {
+                    event.set(digital_actions[i][bit]);
+                } else {
+                    event.clear(digital_actions[i][bit]);
+                }
+            }
+        }
+    }
+    return ctrl_snapshot;
+}
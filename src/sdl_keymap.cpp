@@ -0,0 +1,217 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gamp_impl.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <SDL2/SDL.h>
+
+using namespace gamp;
+
+static_assert(scancode_count == SDL_NUM_SCANCODES);
+
+static constexpr impl::key_action_table_t default_key_actions = []() {
+    impl::key_action_table_t t{};  // NONE
+    t[SDL_SCANCODE_ESCAPE] = input_event_type_t::WINDOW_CLOSE_REQ;
+    t[SDL_SCANCODE_P] = input_event_type_t::PAUSE;
+    t[SDL_SCANCODE_UP] = input_event_type_t::P1_UP;
+    t[SDL_SCANCODE_LEFT] = input_event_type_t::P1_LEFT;
+    t[SDL_SCANCODE_DOWN] = input_event_type_t::P1_DOWN;
+    t[SDL_SCANCODE_RIGHT] = input_event_type_t::P1_RIGHT;
+    t[SDL_SCANCODE_RSHIFT] = input_event_type_t::P1_ACTION1;
+    t[SDL_SCANCODE_RETURN] = input_event_type_t::P1_ACTION2;
+    t[SDL_SCANCODE_RALT] = input_event_type_t::P1_ACTION3;
+    // t[SDL_SCANCODE_RGUI] = input_event_type_t::P1_ACTION4;
+    t[SDL_SCANCODE_W] = input_event_type_t::P2_UP;
+    t[SDL_SCANCODE_A] = input_event_type_t::P2_LEFT;
+    t[SDL_SCANCODE_S] = input_event_type_t::P2_DOWN;
+    t[SDL_SCANCODE_D] = input_event_type_t::P2_RIGHT;
+    t[SDL_SCANCODE_LSHIFT] = input_event_type_t::P2_ACTION1;
+    t[SDL_SCANCODE_LCTRL] = input_event_type_t::P2_ACTION2;
+    t[SDL_SCANCODE_LALT] = input_event_type_t::P2_ACTION3;
+    // t[SDL_SCANCODE_LGUI] = input_event_type_t::P2_ACTION4;
+    t[SDL_SCANCODE_R] = input_event_type_t::RESET;
+    return t;
+}();
+
+constinit const impl::key_ascii_table_t impl::key_ascii_table = []() {
+    key_ascii_table_t t{};  // 0
+    for (int i = 0; i < 26; ++i) {
+        t[SDL_SCANCODE_A + i] = static_cast<uint16_t>('a' + i);
+    }
+    for (int i = 0; i < 9; ++i) {
+        t[SDL_SCANCODE_1 + i] = static_cast<uint16_t>('1' + i);
+    }
+    t[SDL_SCANCODE_0] = '0';
+    t[SDL_SCANCODE_SEMICOLON] = ';';
+    t[SDL_SCANCODE_MINUS] = '-';
+    t[SDL_SCANCODE_KP_MINUS] = '-';
+    t[SDL_SCANCODE_KP_PLUS] = '+';
+    t[SDL_SCANCODE_KP_MULTIPLY] = '*';
+    t[SDL_SCANCODE_SLASH] = '/';
+    t[SDL_SCANCODE_KP_DIVIDE] = '/';
+    t[SDL_SCANCODE_KP_PERCENT] = '%';
+    t[SDL_SCANCODE_KP_LEFTPAREN] = '(';
+    t[SDL_SCANCODE_KP_LEFTBRACE] = '(';
+    t[SDL_SCANCODE_LEFTBRACKET] = '(';
+    t[SDL_SCANCODE_KP_RIGHTPAREN] = ')';
+    t[SDL_SCANCODE_KP_RIGHTBRACE] = ')';
+    t[SDL_SCANCODE_RIGHTBRACKET] = ')';
+    t[SDL_SCANCODE_COMMA] = ',';
+    t[SDL_SCANCODE_PERIOD] = '.';
+    t[SDL_SCANCODE_SPACE] = ' ';
+    t[SDL_SCANCODE_TAB] = ' ';
+    t[SDL_SCANCODE_RETURN] = '\n';
+    t[SDL_SCANCODE_KP_ENTER] = '\n';
+    t[SDL_SCANCODE_BACKSPACE] = 0x08;
+    return t;
+}();
+
+constinit impl::key_action_table_t impl::key_action_table = default_key_actions;
+
+bool gamp::bind_key(int scancode, input_event_type_t action) noexcept {
+    if (0 > scancode || scancode >= static_cast<int>(scancode_count)) {
+        return false;
+    }
+    impl::key_action_table[static_cast<size_t>(scancode)] = action;
+    return true;
+}
+
+input_event_type_t gamp::get_key_binding(int scancode) noexcept {
+    if (0 > scancode || scancode >= static_cast<int>(scancode_count)) {
+        return input_event_type_t::NONE;
+    }
+    return impl::key_action(scancode);
+}
+
+void gamp::reset_key_bindings() noexcept {
+    impl::key_action_table = default_key_actions;
+}
+
+static constexpr std::pair<const char*, input_event_type_t> action_names[] = {
+    { "NONE", input_event_type_t::NONE },
+    { "P1_UP", input_event_type_t::P1_UP },
+    { "P1_DOWN", input_event_type_t::P1_DOWN },
+    { "P1_RIGHT", input_event_type_t::P1_RIGHT },
+    { "P1_LEFT", input_event_type_t::P1_LEFT },
+    { "P1_ACTION1", input_event_type_t::P1_ACTION1 },
+    { "P1_ACTION2", input_event_type_t::P1_ACTION2 },
+    { "P1_ACTION3", input_event_type_t::P1_ACTION3 },
+    { "PAUSE", input_event_type_t::PAUSE },
+    { "P2_UP", input_event_type_t::P2_UP },
+    { "P2_DOWN", input_event_type_t::P2_DOWN },
+    { "P2_RIGHT", input_event_type_t::P2_RIGHT },
+    { "P2_LEFT", input_event_type_t::P2_LEFT },
+    { "P2_ACTION1", input_event_type_t::P2_ACTION1 },
+    { "P2_ACTION2", input_event_type_t::P2_ACTION2 },
+    { "P2_ACTION3", input_event_type_t::P2_ACTION3 },
+    { "RESET", input_event_type_t::RESET },
+    { "WINDOW_CLOSE_REQ", input_event_type_t::WINDOW_CLOSE_REQ },
+};
+
+/** Returns true if given string is a non-negative decimal number, stored in v. */
+static bool to_number(const std::string& s, int& v) noexcept {
+    if (s.empty() || s.size() > 9 || std::string::npos != s.find_first_not_of("0123456789")) {
+        return false;
+    }
+    v = std::atoi(s.c_str());
+    return true;
+}
+
+static bool to_action(const std::string& name, input_event_type_t& action) noexcept {
+    for (const std::pair<const char*, input_event_type_t>& p : action_names) {
+        if (name == p.first) {
+            action = p.second;
+            return true;
+        }
+    }
+    int v;
+    if (to_number(name, v) && is_action_bit(bitno(static_cast<input_event_type_t>(v)))) {
+        action = static_cast<input_event_type_t>(v);
+        return true;
+    }
+    return false;
+}
+
+static std::string trim(const std::string& s) noexcept {
+    const size_t b = s.find_first_not_of(" \t\r\n");
+    if (std::string::npos == b) {
+        return std::string();
+    }
+    return s.substr(b, s.find_last_not_of(" \t\r\n") - b + 1);
+}
+
+bool gamp::load_key_bindings(const std::string& path) noexcept {
+    FILE* in = fopen(path.c_str(), "r");
+    if (nullptr == in) {
+        printf("Key bindings: Error opening %s\n", path.c_str());
+        return false;
+    }
+    bool ok = true;
+    int lineno = 0;
+    char buf[256];
+    while (nullptr != fgets(buf, sizeof(buf), in)) {
+        ++lineno;
+        std::string line(buf);
+        const size_t comment = line.find('#');
+        if (std::string::npos != comment) {
+            line.erase(comment);
+        }
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        const size_t eq = line.find('=');
+        if (std::string::npos == eq) {
+            printf("Key bindings: %s:%d: Missing '=': %s\n", path.c_str(), lineno, line.c_str());
+            ok = false;
+            continue;
+        }
+        const std::string key = trim(line.substr(0, eq));
+        const std::string value = trim(line.substr(eq + 1));
+        int scancode;
+        if (!to_number(key, scancode)) {
+            scancode = SDL_GetScancodeFromName(key.c_str());
+        }
+        input_event_type_t action;
+        if (SDL_SCANCODE_UNKNOWN == scancode || scancode >= static_cast<int>(scancode_count)) {
+            printf("Key bindings: %s:%d: Unknown key '%s'\n", path.c_str(), lineno, key.c_str());
+            ok = false;
+        } else if (!to_action(value, action)) {
+            printf("Key bindings: %s:%d: Unknown action '%s'\n", path.c_str(), lineno, value.c_str());
+            ok = false;
+        } else {
+            bind_key(scancode, action);
+        }
+    }
+    if (0 != ferror(in)) {
+        printf("Key bindings: Error reading %s\n", path.c_str());
+        ok = false;
+    }
+    fclose(in);
+    return ok;
+}
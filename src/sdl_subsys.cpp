@@ -22,6 +22,9 @@
  * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include <gamp/gamp.hpp>
+#include <gamp/profile.hpp>
+#include <gamp/spsc_ring.hpp>
+#include "gamp_impl.hpp"
 
 #include <jau/basic_types.hpp>
 #include <jau/environment.hpp>
@@ -30,7 +33,11 @@
 #include <jau/secmem.hpp>
 #include <jau/util/VersionNumber.hpp>
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "gamp/version.hpp"
 
 #include <GLES2/gl2.h>
@@ -44,76 +51,269 @@ static SDL_Window* sdl_win = nullptr;
 static Uint32 sdl_win_id = 0;
 static SDL_GLContext sdl_glc = nullptr;
 static SDL_Renderer* sdl_rend = nullptr;
+static bool gfx_vsync = false;
+static bool gfx_headless = false;
+static impl::fbo_t headless_fbo;
+
+/** Statistics of the last completed period, see end_stats_period(). */
+struct gpu_stats_t {
+    float fps = 0.0f;
+    double frame_costs_in_sec = 0.0;
+    double frame_slept_in_sec = 0.0;
+    duration_percentiles_t frame_pct;
+    duration_percentiles_t input_latency_pct;
+    double gpu_costs_in_sec = 0.0;
+    duration_percentiles_t gpu_pct;
+};
+typedef duration_ring_t<gpu_stats_frame_times_capacity> gpu_frame_times_t;
+
+/**
+ * Statistics published by the thread swapping buffers, possibly the render thread,
+ * and acquired by the get_gpu_stats_*() getters as a consistent snapshot, see gpu_stats_latest().
+ */
+static triple_buffer_t<gpu_stats_t> gpu_stats;
+/** Most recent frame times published per frame, see get_gpu_stats_frame_times(). */
+static triple_buffer_t<gpu_frame_times_t> gpu_frame_times_pub;
+/** Set by end_gpu_stats_period() while the render thread runs, ending the period with its next frame. */
+static std::atomic<bool> gpu_stats_end_requested{false};
 
-static float gpu_stats_fps = 0.0f;
-static double gpu_stats_frame_costs_in_sec = 0.0, gpu_stats_frame_slept_in_sec = 0.0;
 static int gpu_stats_frame_count = 0;
-static jau::fraction_timespec gpu_fps_t0, gpu_swap_t0;
+static jau::fraction_timespec gpu_fps_t0, gpu_swap_t0, gpu_swap_t1_last;
+static duration_histogram_t gpu_frame_histogram;
+static gpu_frame_times_t gpu_frame_times;
+static uint64_t gpu_frames_over_budget = 0;
+/**
+ * OS timestamp in nanoseconds of the oldest input event handled since the last frame, zero if none.
+ * Accessed by the thread handling events only, taken by the frame consuming it, see impl::take_input_latency_t0().
+ */
+static int64_t input_latency_t0_ns = 0;
+static duration_histogram_t input_latency_histogram;
+static uint64_t input_latency_over_budget = 0;
 
 jau::math::Recti gamp::viewport;
 
+static int64_t to_ns(const jau::fraction_timespec& t) noexcept {
+    return t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+void* gamp::impl::get_gl_proc_address(const char* name) noexcept {
+    return SDL_GL_GetProcAddress(name);
+}
+
+bool gamp::impl::make_gl_context_current(bool current) noexcept {
+    if (0 != SDL_GL_MakeCurrent(sdl_win, current ? sdl_glc : nullptr)) {
+        log_printf(log_level_t::error, "SDL: Error %s GL context: %s\n", current ? "making current" : "releasing", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+/** Display of the window whose refresh rate is display_frames_per_sec, -1 if unknown. */
+static int win_display_idx = -1;
+/** Window size as known by the thread handling events, e.g. converting touch positions, while win_width and win_height are owned by the rendering thread. */
+static int event_win_width = 0;
+static int event_win_height = 0;
+/** Resize of the primary window to be applied by the render thread with the next submitted frame, see impl::take_pending_resize(). */
+static render_frame_t::resize_t resize_pending_frame;
+
+/** Returns given window size packed for win_resize_pending, width in upper and height in lower 32 bits. */
+static uint64_t pack_size(int wwidth, int wheight) noexcept {
+    return static_cast<uint64_t>(static_cast<uint32_t>(wwidth)) << 32 | static_cast<uint32_t>(wheight);
+}
+static int unpack_width(uint64_t v) noexcept { return static_cast<int32_t>(static_cast<uint32_t>(v >> 32)); }
+static int unpack_height(uint64_t v) noexcept { return static_cast<int32_t>(static_cast<uint32_t>(v)); }
+/** Latest window size recorded by on_event_watch(), width in upper and height in lower 32 bits, UINT64_MAX if none pending. */
+static std::atomic<uint64_t> win_resize_pending{UINT64_MAX};
+
+void gamp::impl::apply_resize(const render_frame_t::resize_t& r) noexcept {
+    if (!r.pending) {
+        return;
+    }
+    win_width = r.win_width;
+    win_height = r.win_height;
+    glViewport(0, 0, r.fb_width, r.fb_height);
+    viewport.setWidth(r.fb_width);
+    viewport.setHeight(r.fb_height);
+    if (0 < r.display_fps) {
+        display_frames_per_sec = r.display_fps;
+    }
+    log_printf(log_level_t::debug, "VP Size %s\n", viewport.toString().c_str());
+}
+
+render_frame_t::resize_t gamp::impl::take_pending_resize() noexcept {
+    const render_frame_t::resize_t r = resize_pending_frame;
+    resize_pending_frame = render_frame_t::resize_t();
+    return r;
+}
+
+/** Determines the window and framebuffer size of a resize on the thread handling events, applied directly or by the render thread. */
 static void on_window_resized(int wwidth, int wheight) noexcept {
     int wwidth2 = 0, wheight2 = 0;
     SDL_GetWindowSize(sdl_win, &wwidth2, &wheight2);
 
-    printf("Win Size %d x %d -> %d x %d (given), %d x %d (query)\n", win_width, win_height, wwidth, wheight, wwidth2, wheight2);
+    log_printf(log_level_t::debug, "Win Size %d x %d -> %d x %d (given), %d x %d (query)\n", event_win_width, event_win_height, wwidth, wheight, wwidth2, wheight2);
     if (0 == wwidth || 0 == wheight) {
         wwidth = wwidth2;
         wheight = wheight2;
     }
-    win_width = wwidth;
-    win_height = wheight;
+    event_win_width = wwidth;
+    event_win_height = wheight;
 
-    int fb_width = 0;
-    int fb_height = 0;
-    SDL_RendererInfo sdi;
+    render_frame_t::resize_t r;
+    r.pending = true;
+    r.win_width = wwidth;
+    r.win_height = wheight;
     if (nullptr != sdl_rend) {
-        SDL_GetRendererOutputSize(sdl_rend, &fb_width, &fb_height);
-        SDL_GetRendererInfo(sdl_rend, &sdi);
-        printf("SDL Renderer %s\n", sdi.name);
-        printf("SDL Renderer Size %d x %d\n", fb_width, fb_height);
+        SDL_GetRendererOutputSize(sdl_rend, &r.fb_width, &r.fb_height);
+        if (is_log_enabled(log_level_t::debug)) {
+            SDL_RendererInfo sdi;
+            SDL_GetRendererInfo(sdl_rend, &sdi);
+            log_printf(log_level_t::debug, "SDL Renderer %s, size %d x %d\n", sdi.name, r.fb_width, r.fb_height);
+        }
     } else {
-        printf("SDL Renderer null\n");
-        fb_width = static_cast<int>(static_cast<float>(wwidth) * devicePixelRatio[0]);
-        fb_height = static_cast<int>(static_cast<float>(wheight) * devicePixelRatio[1]);
-        printf("DevicePixelRatio Size %f x %f -> %d x %d\n",
-               devicePixelRatio[0], devicePixelRatio[1], fb_width, fb_height);
+        r.fb_width = static_cast<int>(static_cast<float>(wwidth) * devicePixelRatio[0]);
+        r.fb_height = static_cast<int>(static_cast<float>(wheight) * devicePixelRatio[1]);
+        log_printf(log_level_t::debug, "SDL Renderer null, DevicePixelRatio Size %f x %f -> %d x %d\n",
+                   devicePixelRatio[0], devicePixelRatio[1], r.fb_width, r.fb_height);
     }
 
-    glViewport(0, 0, fb_width, fb_height);
-    viewport.setWidth(fb_width);
-    viewport.setHeight(fb_height);
-    printf("VP Size %s\n", viewport.toString().c_str());
-    {
+    const int display_idx = SDL_GetWindowDisplayIndex(sdl_win);
+    if (display_idx != win_display_idx) {
+        // refresh rate only changes with the display
         SDL_DisplayMode mode;
-        const int win_display_idx = SDL_GetWindowDisplayIndex(sdl_win);
         jau::zero_bytes_sec(&mode, sizeof(mode));
-        SDL_GetCurrentDisplayMode(win_display_idx, &mode);  // SDL_GetWindowDisplayMode(..) fails on some systems (wrong refresh_rate and logical size
-        printf("WindowDisplayMode: %d x %d @ %d Hz @ display %d\n", mode.w, mode.h, mode.refresh_rate, win_display_idx);
-        display_frames_per_sec = mode.refresh_rate;
+        SDL_GetCurrentDisplayMode(display_idx, &mode);  // SDL_GetWindowDisplayMode(..) fails on some systems (wrong refresh_rate and logical size
+        log_printf(log_level_t::info, "WindowDisplayMode: %d x %d @ %d Hz @ display %d\n", mode.w, mode.h, mode.refresh_rate, display_idx);
+        win_display_idx = display_idx;
+        r.display_fps = mode.refresh_rate;
+    } else if (resize_pending_frame.pending) {
+        r.display_fps = resize_pending_frame.display_fps;  // keep a not yet submitted display change
+    }
+
+    if (impl::render_thread_active()) {
+        resize_pending_frame = r;  // the render thread owns the GL context, viewport and window size
+    } else {
+        impl::apply_resize(r);
     }
 }
 
-bool gamp::init_gfx_subsystem(const char* title, int wwidth, int wheight, bool enable_vsync) {
-    printf("Gamp API %s, lib %s\n", gamp::VERSION_API, gamp::VERSION.toString().c_str());    
-    printf("%s\n", jau::os::get_platform_info().c_str());
-    
-    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {  // SDL_INIT_EVERYTHING
-        printf("SDL: Error initializing: %s\n", SDL_GetError());
-        return false;
+/** Records the latest window size, applied once per frame by apply_window_resize(). */
+static void request_window_resize(int wwidth, int wheight) noexcept {
+    win_resize_pending.store(pack_size(wwidth, wheight), std::memory_order_release);
+}
+
+/** Presentation statistics of a surface, see surface_info_t. */
+struct surface_stats_t {
+    float fps = 0.0f;
+    double swap_costs = 0.0;
+};
+
+struct gamp::surface_t {
+    SDL_Window* win = nullptr;
+    SDL_GLContext glc = nullptr;
+    /** State owned by the thread handling events, except fps and swap_costs, see get_surface_info(). */
+    surface_info_t info;
+    /** Latest window size recorded by on_event_watch(), see win_resize_pending. */
+    std::atomic<uint64_t> resize_pending{UINT64_MAX};
+    std::atomic<bool> close_requested{false};
+    /** Framebuffer size handed to the rendering thread for make_surface_current(), packed as by pack_size(). */
+    std::atomic<uint64_t> fb_size{0};
+    /** Owned by the rendering thread, presenting the surface. */
+    int frame_count = 0;
+    jau::fraction_timespec td_swap;
+    /** Published per period by the rendering thread, acquired by get_surface_info() on the thread handling events. */
+    mutable triple_buffer_t<surface_stats_t> stats;
+};
+
+/** Additional surfaces, modified on the event thread only. */
+static std::vector<std::unique_ptr<surface_t>> surfaces;
+
+static surface_t* find_surface(Uint32 sdl_win_id_) noexcept {
+    for (const std::unique_ptr<surface_t>& s : surfaces) {
+        if (s->info.window_id == sdl_win_id_) {
+            return s.get();
+        }
     }
-    if (enable_vsync) {
-        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+    return nullptr;
+}
+
+/** Returns the event_t::window_id of given SDL window id, i.e. 0 for the primary window. */
+static uint32_t to_window_id(Uint32 sdl_win_id_) noexcept {
+    return sdl_win_id == sdl_win_id_ ? 0 : sdl_win_id_;
+}
+
+static void on_surface_resized(surface_t& s, int wwidth, int wheight) noexcept {
+    int fb_width = 0, fb_height = 0;
+    SDL_GL_GetDrawableSize(s.win, &fb_width, &fb_height);
+    s.info.win_width = wwidth;
+    s.info.win_height = wheight;
+    s.info.viewport.setWidth(fb_width);
+    s.info.viewport.setHeight(fb_height);
+    s.fb_size.store(pack_size(fb_width, fb_height), std::memory_order_release);
+    ++s.info.resize_count;
+    log_printf(log_level_t::debug, "Surface %u Size %d x %d, VP %s\n", s.info.window_id, wwidth, wheight, s.info.viewport.toString().c_str());
+}
+
+/**
+ * SDL event watch, invoked synchronously when an event is queued,
+ * i.e. within SDL_PumpEvents() or a platform's modal live resize loop.
+ */
+static int SDLCALL on_event_watch(void* /* userdata */, SDL_Event* sdl_event) {
+    if (SDL_WINDOWEVENT != sdl_event->type) {
+        return 0;
     }
-    // SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, std::to_string(gamp_filter_quality).c_str());
+    const bool primary = sdl_win_id == sdl_event->window.windowID;
+    surface_t* s = primary ? nullptr : find_surface(sdl_event->window.windowID);  // null for unknown windows, e.g. not yet created or destroyed
+    switch (sdl_event->window.event) {
+        case SDL_WINDOWEVENT_RESIZED:
+            if (primary) {
+                request_window_resize(sdl_event->window.data1, sdl_event->window.data2);
+            } else if (nullptr != s) {
+                s->resize_pending.store(pack_size(sdl_event->window.data1, sdl_event->window.data2), std::memory_order_release);
+            }
+            break;
+        case SDL_WINDOWEVENT_CLOSE:
+            if (nullptr != s) {
+                s->close_requested.store(true, std::memory_order_release);
+            }
+            break;
+        default: break;
+    }
+    return 0;
+}
 
-    const Uint32 win_flags = SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL;  //  | SDL_WINDOW_SHOWN;
+/** Applies the latest window sizes and close requests recorded since the last call, if any. Returns true if the primary window has been resized. */
+static bool apply_window_resize() noexcept {
+    for (const std::unique_ptr<surface_t>& s : surfaces) {
+        const uint64_t v = s->resize_pending.exchange(UINT64_MAX, std::memory_order_acq_rel);
+        if (UINT64_MAX != v) {
+            on_surface_resized(*s, unpack_width(v), unpack_height(v));
+        }
+        s->info.close_requested = s->close_requested.load(std::memory_order_acquire);
+    }
+    const uint64_t v = win_resize_pending.exchange(UINT64_MAX, std::memory_order_acq_rel);
+    if (UINT64_MAX == v) {
+        return false;
+    }
+    on_window_resized(unpack_width(v), unpack_height(v));
+    return true;
+}
 
-    if (0 != win_width && 0 != win_height) {
-        // override using pre-set default, i.e. set_window_size(..)
-        wwidth = win_width;
-        wheight = win_height;
+/** Destroys the primary GL context and window, if any, clearing their handles. */
+static void destroy_window_and_context() noexcept {
+    if (nullptr != sdl_glc) {
+        SDL_GL_DeleteContext(sdl_glc);
+        sdl_glc = nullptr;
     }
+    if (nullptr != sdl_win) {
+        SDL_DestroyWindow(sdl_win);
+        sdl_win = nullptr;
+    }
+    sdl_win_id = 0;
+}
+
+/** Creates the SDL window and a GL ES 3 or ES 2 context, made current. On failure, both are destroyed and their handles cleared. */
+static bool create_window_and_context(const char* title, int wwidth, int wheight, Uint32 win_flags, bool enable_vsync) noexcept {
     sdl_win = SDL_CreateWindow(title,
                                SDL_WINDOWPOS_UNDEFINED,
                                SDL_WINDOWPOS_UNDEFINED,
@@ -127,11 +327,13 @@ bool gamp::init_gfx_subsystem(const char* title, int wwidth, int wheight, bool e
     sdl_win_id = SDL_GetWindowID(sdl_win);
     if (0 == sdl_win_id) {
         printf("SDL: Error retrieving window ID: %s\n", SDL_GetError());
-        SDL_DestroyWindow(sdl_win);
+        destroy_window_and_context();
         return false;
     }
+    SDL_StopTextInput();  // enabled on demand only, see start_text_input()
 
     // Create OpenGL ES 3 or ES 2 context on SDL window
+    gfx_vsync = enable_vsync;
     SDL_GL_SetSwapInterval(enable_vsync ? 1 : 0);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
@@ -147,38 +349,288 @@ bool gamp::init_gfx_subsystem(const char* title, int wwidth, int wheight, bool e
         sdl_glc = SDL_GL_CreateContext(sdl_win);
         if (nullptr == sdl_glc) {
             printf("SDL: Error creating GL ES 2 context: %s\n", SDL_GetError());
-            SDL_DestroyWindow(sdl_win);
+            destroy_window_and_context();
             return false;
         }
     }
     if (0 != SDL_GL_MakeCurrent(sdl_win, sdl_glc)) {
         printf("SDL: Error making GL context current: %s\n", SDL_GetError());
-        SDL_GL_DeleteContext(sdl_glc);
-        SDL_DestroyWindow(sdl_win);
+        destroy_window_and_context();
         return false;
     }
     const char* gl_version_cstr = reinterpret_cast<const char*>( glGetString(GL_VERSION) );
     if (nullptr == gl_version_cstr) {
         printf("SDL: Error retrieving GL version: %s\n", SDL_GetError());
-        SDL_GL_DeleteContext(sdl_glc);
-        SDL_DestroyWindow(sdl_win);
+        destroy_window_and_context();
         return false;
     }
     gl_version = jau::util::VersionNumber( gl_version_cstr );
     printf("SDL GL context: %s\n", gl_version.toString().c_str());
+    impl::probe_gl_caps();
+    return true;
+}
 
-    // const Uint32 render_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
-    sdl_rend = SDL_GetRenderer(sdl_win);  // SDL_CreateRenderer(sdl_win, -1, render_flags);
-
-    gpu_stats_fps = 0.0f;
+/** Resets the frame statistics and starts the GPU timer for the first frame. */
+static void init_frame_stats() noexcept {
+    gpu_stats.publish(gpu_stats_t());
+    gpu_frame_times_pub.back().clear();
+    gpu_frame_times_pub.publish();
     gpu_fps_t0 = jau::getMonotonicTime();
     gpu_swap_t0 = gpu_fps_t0;
+    gpu_swap_t1_last = gpu_fps_t0;
     gpu_stats_frame_count = 0;
+    gpu_frame_histogram.clear();
+    gpu_frame_times.clear();
+    gpu_frames_over_budget = 0;
+    input_latency_t0_ns = 0;
+    input_latency_histogram.clear();
+    input_latency_over_budget = 0;
+
+    impl::gpu_timer_init();
+    impl::gpu_timer_begin_frame(0 < forced_fps ? forced_fps : display_frames_per_sec);
+}
+
+bool gamp::init_gfx_subsystem(const char* title, int wwidth, int wheight, bool enable_vsync) {
+    printf("Gamp API %s, lib %s\n", gamp::VERSION_API, gamp::VERSION.toString().c_str());    
+    printf("%s\n", jau::os::get_platform_info().c_str());
+    
+    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {  // SDL_INIT_EVERYTHING
+        printf("SDL: Error initializing: %s\n", SDL_GetError());
+        return false;
+    }
+    if (enable_vsync) {
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+    }
+    // SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, std::to_string(gamp_filter_quality).c_str());
+
+    const Uint32 win_flags = SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL;  //  | SDL_WINDOW_SHOWN;
+
+    if (0 != win_width && 0 != win_height) {
+        // override using pre-set default, i.e. set_window_size(..)
+        wwidth = win_width;
+        wheight = win_height;
+    }
+    if (!create_window_and_context(title, wwidth, wheight, win_flags, enable_vsync)) {
+        return false;
+    }
+
+    // const Uint32 render_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
+    sdl_rend = SDL_GetRenderer(sdl_win);  // SDL_CreateRenderer(sdl_win, -1, render_flags);
 
     on_window_resized(wwidth, wheight);
+    SDL_AddEventWatch(on_event_watch, nullptr);
+    init_frame_stats();
     return true;
 }
 
+bool gamp::init_gfx_subsystem_headless(int fb_width, int fb_height) {
+    printf("Gamp API %s, lib %s\n", gamp::VERSION_API, gamp::VERSION.toString().c_str());
+    printf("%s\n", jau::os::get_platform_info().c_str());
+#if defined(__EMSCRIPTEN__)
+    (void)fb_width;
+    (void)fb_height;
+    printf("SDL: Headless mode not supported on WebAssembly\n");
+    return false;
+#else
+    // SDL's offscreen driver uses an EGL pbuffer or surfaceless context, no display required.
+    // Falls back to a hidden window of the default driver if it fails to initialize or to create a context, e.g. without EGL.
+    bool created = false;
+    for (const char* driver : { "offscreen", static_cast<const char*>(nullptr) }) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, driver);  // null restores the default driver, SDL_ResetHint() requires SDL >= 2.24
+        if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {
+            printf("SDL: Error initializing %s video driver: %s\n", nullptr != driver ? driver : "default", SDL_GetError());
+            continue;
+        }
+        printf("SDL video driver: %s\n", SDL_GetCurrentVideoDriver());
+        if (create_window_and_context("gamp headless", fb_width, fb_height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN, false)) {
+            created = true;
+            break;
+        }
+        SDL_Quit();
+    }
+    if (!created) {
+        return false;
+    }
+    if (!impl::create_fbo(headless_fbo, fb_width, fb_height, gl_caps.es3)) {
+        printf("SDL: Error creating headless framebuffer %d x %d\n", fb_width, fb_height);
+        destroy_window_and_context();
+        SDL_Quit();
+        return false;
+    }
+    gfx_headless = true;
+    win_width = fb_width;
+    win_height = fb_height;
+    event_win_width = fb_width;
+    event_win_height = fb_height;
+    devicePixelRatio[0] = 1.0f;
+    devicePixelRatio[1] = 1.0f;
+    glViewport(0, 0, fb_width, fb_height);
+    viewport.setWidth(fb_width);
+    viewport.setHeight(fb_height);
+    printf("Headless FB %s, fbo %u\n", viewport.toString().c_str(), headless_fbo.fbo);
+
+    init_frame_stats();
+    return true;
+#endif
+}
+
+bool gamp::is_headless() noexcept {
+    return gfx_headless;
+}
+
+uint32_t gamp::default_framebuffer() noexcept {
+    return headless_fbo.fbo;
+}
+
+/**
+ * Creates a GL context for given window sharing GL objects with the primary context using its attributes.
+ * Shall be called on the thread the primary context is current, which remains current.
+ */
+static SDL_GLContext create_shared_context(SDL_Window* win) noexcept {
+    SDL_GL_MakeCurrent(sdl_win, sdl_glc);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext glc = SDL_GL_CreateContext(win);  // made current if successful
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    SDL_GL_MakeCurrent(sdl_win, sdl_glc);
+    return glc;
+}
+
+bool impl::create_shared_gl_context(shared_gl_context_t& ctx) noexcept {
+    if (nullptr == sdl_glc || impl::render_thread_active()) {
+        log_printf(log_level_t::error, "SDL: Error creating shared GL context, requires the primary context being current\n");
+        return false;
+    }
+    SDL_Window* win = SDL_CreateWindow("gamp shared", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 1, 1,
+                                       SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);  // a window surface is current in one context only
+    if (nullptr == win) {
+        log_printf(log_level_t::error, "SDL: Error creating shared GL context window: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_GLContext glc = create_shared_context(win);
+    if (nullptr == glc) {
+        log_printf(log_level_t::error, "SDL: Error creating shared GL context: %s\n", SDL_GetError());
+        SDL_DestroyWindow(win);
+        return false;
+    }
+    ctx.win = win;
+    ctx.glc = glc;
+    return true;
+}
+
+bool impl::make_shared_gl_context_current(const shared_gl_context_t& ctx, bool current) noexcept {
+    if (0 != SDL_GL_MakeCurrent(static_cast<SDL_Window*>(ctx.win), current ? ctx.glc : nullptr)) {
+        log_printf(log_level_t::error, "SDL: Error %s shared GL context: %s\n", current ? "making current" : "releasing", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void impl::destroy_shared_gl_context(shared_gl_context_t& ctx) noexcept {
+    if (nullptr != ctx.glc) {
+        SDL_GL_DeleteContext(ctx.glc);
+        ctx.glc = nullptr;
+    }
+    if (nullptr != ctx.win) {
+        SDL_DestroyWindow(static_cast<SDL_Window*>(ctx.win));
+        ctx.win = nullptr;
+    }
+}
+
+surface_t* gamp::create_surface(const char* title, int wwidth, int wheight) noexcept {
+#if defined(__EMSCRIPTEN__)
+    (void)title;
+    (void)wwidth;
+    (void)wheight;
+    log_printf(log_level_t::error, "SDL: Additional surfaces not supported on WebAssembly\n");
+    return nullptr;
+#else
+    if (nullptr == sdl_glc || gfx_headless) {
+        log_printf(log_level_t::error, "SDL: Error creating surface, requires init_gfx_subsystem()\n");
+        return nullptr;
+    }
+    if (impl::render_thread_active()) {
+        log_printf(log_level_t::error, "SDL: Error creating surface while the render thread is running\n");  // it owns the primary context and presents the surfaces
+        return nullptr;
+    }
+    std::unique_ptr<surface_t> s = std::make_unique<surface_t>();
+    s->win = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, wwidth, wheight,
+                              SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL);
+    if (nullptr == s->win) {
+        log_printf(log_level_t::error, "SDL: Error creating surface window: %s\n", SDL_GetError());
+        return nullptr;
+    }
+    s->info.window_id = SDL_GetWindowID(s->win);
+    s->glc = create_shared_context(s->win);
+    if (nullptr == s->glc) {
+        log_printf(log_level_t::error, "SDL: Error creating surface GL context: %s\n", SDL_GetError());
+        SDL_DestroyWindow(s->win);
+        return nullptr;
+    }
+    SDL_GL_MakeCurrent(s->win, s->glc);
+    SDL_GL_SetSwapInterval(0);  // the primary window's swap paces all surfaces
+    SDL_GL_MakeCurrent(sdl_win, sdl_glc);
+
+    int ww = 0, wh = 0;
+    SDL_GetWindowSize(s->win, &ww, &wh);
+    on_surface_resized(*s, ww, wh);
+    log_printf(log_level_t::info, "Surface %u created: %d x %d, VP %s\n", s->info.window_id, ww, wh, s->info.viewport.toString().c_str());
+    surfaces.push_back(std::move(s));
+    return surfaces.back().get();
+#endif
+}
+
+void gamp::destroy_surface(surface_t* s) noexcept {
+    if (impl::render_thread_active()) {
+        log_printf(log_level_t::error, "SDL: Error destroying surface while the render thread is running\n");
+        return;
+    }
+    for (auto it = surfaces.begin(); it != surfaces.end(); ++it) {
+        if (it->get() == s) {
+            SDL_GL_MakeCurrent(sdl_win, sdl_glc);
+            SDL_GL_DeleteContext(s->glc);
+            SDL_DestroyWindow(s->win);
+            surfaces.erase(it);
+            return;
+        }
+    }
+}
+
+bool gamp::make_surface_current(surface_t* s) noexcept {
+    SDL_Window* win = nullptr != s ? s->win : sdl_win;
+    SDL_GLContext glc = nullptr != s ? s->glc : sdl_glc;
+    if (0 != SDL_GL_MakeCurrent(win, glc)) {
+        log_printf(log_level_t::error, "SDL: Error making surface current: %s\n", SDL_GetError());
+        return false;
+    }
+    if (nullptr != s) {
+        const uint64_t v = s->fb_size.load(std::memory_order_acquire);
+        glViewport(0, 0, unpack_width(v), unpack_height(v));
+    } else {
+        glViewport(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+    }
+    return true;
+}
+
+surface_info_t gamp::get_surface_info(const surface_t* s) noexcept {
+    surface_info_t info = s->info;
+    s->stats.update();
+    info.fps = s->stats.front().fps;
+    info.swap_costs = s->stats.front().swap_costs;
+    return info;
+}
+
+/** Presents all additional surfaces, making the primary window current afterwards. */
+static void present_surfaces() noexcept {
+    for (const std::unique_ptr<surface_t>& s : surfaces) {
+        const jau::fraction_timespec t0 = jau::getMonotonicTime();
+        SDL_GL_MakeCurrent(s->win, s->glc);
+        SDL_GL_SwapWindow(s->win);
+        s->td_swap += jau::getMonotonicTime() - t0;
+        ++s->frame_count;
+    }
+    SDL_GL_MakeCurrent(sdl_win, sdl_glc);
+}
+
 extern "C" {
     EMSCRIPTEN_KEEPALIVE void set_forced_fps(int v) noexcept { forced_fps = v; }
 
@@ -203,7 +655,7 @@ extern "C" {
                            win_width, win_height, ww, wh, devicePixelRatio[0], devicePixelRatio[1]);
                     SDL_SetWindowSize(sdl_win, ww, wh);
                     warn_once = true;
-                    on_window_resized(ww, wh);
+                    request_window_resize(ww, wh);
                 }
             } else if (warn_once) {
                 warn_once = false;
@@ -225,57 +677,266 @@ static jau::fraction_timespec td_slept = 0_s;
 static jau::fraction_timespec gpu_stats_period = 5_s;
 static bool gpu_stats_show = false;
 
+/** Remaining time before the frame deadline, which is busy-waited instead of slept to avoid oversleeping. */
+static const jau::fraction_timespec pacer_spin_margin(1_ms / 2_i64);
+/** Absolute monotonic deadline of the current frame, only valid if pacer_fps > 0. */
+static jau::fraction_timespec pacer_deadline;
+/** Frames per second the pacer_deadline has been aligned to, 0 if inactive. */
+static int pacer_fps = 0;
+
+/**
+ * Absolute deadline frame pacer, using next-deadline = last-deadline + period.
+ *
+ * Sleeps coarsely until pacer_spin_margin before the deadline and yields for the remaining time.
+ * A frame late less than one period keeps the deadline to catch up,
+ * a frame late by one or more periods skips the missed deadlines and re-aligns to now.
+ */
+static void pace_frame(const jau::fraction_timespec& gpu_swap_t1, int fps) noexcept {
+    GAMP_PROFILE_ZONE("pace_frame");
+    const jau::fraction_timespec td_per_frame(1_s / (int64_t)fps);
+    if (fps != pacer_fps) {
+        pacer_fps = fps;
+        pacer_deadline = gpu_swap_t1;
+    }
+    pacer_deadline += td_per_frame;
+    if (gpu_swap_t1 >= pacer_deadline) {
+        if (gpu_swap_t1 - pacer_deadline >= td_per_frame) {
+            pacer_deadline = gpu_swap_t1;  // skip missed frames
+        }
+        gpu_swap_t0 = gpu_swap_t1;
+        return;
+    }
+    jau::fraction_timespec now = gpu_swap_t1;
+    if (pacer_deadline - now > pacer_spin_margin) {
+        jau::sleep(pacer_deadline - now - pacer_spin_margin, false);  // allow IRQ
+        now = jau::getMonotonicTime();
+    }
+    while (now < pacer_deadline) {
+        std::this_thread::yield();
+        now = jau::getMonotonicTime();
+    }
+    td_slept += now - gpu_swap_t1;
+    gpu_swap_t0 = now;
+}
+
+static bool fps_gov_enabled = false;
+/** Maximum divisor of the base frame rate, e.g. 60 -> 15 fps */
+static constexpr int fps_gov_max_divisor = 4;
+/** Atomic as read by get_fps_governor_divisor(), while written by the render thread if running. */
+static std::atomic<int> fps_gov_divisor{1};
+/** True if fps_gov_divisor is realized via the vsync swap interval, otherwise via the frame pacer. */
+static bool fps_gov_swap_interval = false;
+static std::atomic<uint64_t> fps_gov_switches{0};
+static int fps_gov_good_windows = 0;
+static int fps_gov_window_frames = 0;
+static duration_histogram_t fps_gov_histogram;
+
+static void fps_gov_set_divisor(int divisor, int fps) noexcept {
+    if (divisor != fps_gov_divisor.load(std::memory_order_relaxed)) {
+        fps_gov_switches.fetch_add(1, std::memory_order_relaxed);
+    }
+    fps_gov_divisor.store(divisor, std::memory_order_relaxed);
+    fps_gov_good_windows = 0;
+    fps_gov_swap_interval = false;
+    if (gfx_vsync) {
+        fps_gov_swap_interval = 0 >= fps && 1 < divisor && 0 == SDL_GL_SetSwapInterval(divisor);
+        if (!fps_gov_swap_interval) {
+            SDL_GL_SetSwapInterval(1);
+        }
+    }
+}
+
+/**
+ * Evaluates the frame costs of the last ~0.5s window against the budget of the current and next faster divisor.
+ *
+ * Hysteresis: Switches to the next slower rate after one window with p90 costs above 95% of the budget,
+ * but only back to the next faster rate after 4 consecutive windows with p90 costs below 75% of its budget.
+ */
+static void fps_gov_update(uint64_t cost_us, int base_fps, int fps) noexcept {
+    fps_gov_histogram.add(cost_us);
+    if (++fps_gov_window_frames < std::max(15, base_fps / fps_gov_divisor.load(std::memory_order_relaxed) / 2)) {
+        return;
+    }
+    const uint64_t p90_us = fps_gov_histogram.percentile_us(0.90);
+    fps_gov_histogram.clear();
+    fps_gov_window_frames = 0;
+    const int divisor = fps_gov_divisor.load(std::memory_order_relaxed);
+    const uint64_t budget_us = 1000000 * static_cast<uint64_t>(divisor) / static_cast<uint64_t>(base_fps);
+    const uint64_t faster_budget_us = 1000000 * static_cast<uint64_t>(divisor - 1) / static_cast<uint64_t>(base_fps);
+    if (p90_us * 100 > budget_us * 95) {
+        if (divisor < fps_gov_max_divisor) {
+            fps_gov_set_divisor(divisor + 1, fps);
+        }
+        fps_gov_good_windows = 0;
+    } else if (1 < divisor && p90_us * 100 < faster_budget_us * 75) {
+        if (++fps_gov_good_windows >= 4) {
+            fps_gov_set_divisor(divisor - 1, fps);
+        }
+    } else {
+        fps_gov_good_windows = 0;
+    }
+}
+
+/** Publishes the statistics of the period ending at given time and starts a new period. */
+static void end_stats_period(const jau::fraction_timespec& gpu_swap_t1, int fps, int budget_fps) noexcept {
+    const jau::fraction_timespec td = gpu_swap_t1 - gpu_fps_t0;
+    const double gpu_frame_count_d = std::max(1, gpu_stats_frame_count);
+    gpu_stats_t& st = gpu_stats.back();
+    st.fps = (float)gpu_stats_frame_count / ((float)td.tv_sec + ((float)td.tv_nsec / 1000000000.0f));
+    st.frame_costs_in_sec = ((double)td_net_costs.tv_sec + ((double)td_net_costs.tv_nsec / 1000000000.0f)) / gpu_frame_count_d;
+    st.frame_slept_in_sec = ((double)td_slept.tv_sec + ((double)td_slept.tv_nsec / 1000000000.0f)) / gpu_frame_count_d;
+    st.frame_pct = gpu_frame_histogram.percentiles(gpu_frames_over_budget);
+    st.input_latency_pct = input_latency_histogram.percentiles(input_latency_over_budget);
+    impl::gpu_timer_end_period(st.gpu_costs_in_sec, st.gpu_pct);
+    if (gpu_stats_show) {
+        jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "fps: %f (req %d), frames %d, td %s, costs %fms/frame, slept %fms/frame\n",
+                        st.fps, fps, gpu_stats_frame_count, td.to_string().c_str(), st.frame_costs_in_sec * 1000.0, st.frame_slept_in_sec * 1000.0);
+        jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "frame-time: %s\n", st.frame_pct.toString().c_str());
+        if (fps_gov_enabled) {
+            jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "fps-governor: divisor %d, %d fps (%s), switches %" PRIu64 "\n",
+                            fps_gov_divisor.load(std::memory_order_relaxed), budget_fps, fps_gov_swap_interval ? "swap-interval" : "pacer",
+                            fps_gov_switches.load(std::memory_order_relaxed));
+        }
+        if (get_dynamic_resolution()) {
+            jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "render-scale: %f\n", get_render_scale());
+        }
+        if (has_gpu_timer_query()) {
+            jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "gpu-time: %fms/frame, %s\n",
+                            st.gpu_costs_in_sec * 1000.0, st.gpu_pct.toString().c_str());
+        }
+        if (0 < st.input_latency_pct.count) {
+            jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "input-latency: %s\n", st.input_latency_pct.toString().c_str());
+        }
+    }
+    gpu_stats.publish();
+    const double td_sec = (double)td.tv_sec + ((double)td.tv_nsec / 1000000000.0);
+    for (const std::unique_ptr<surface_t>& s : surfaces) {
+        surface_stats_t& ss = s->stats.back();
+        ss.fps = static_cast<float>(s->frame_count / td_sec);
+        ss.swap_costs = ((double)s->td_swap.tv_sec + ((double)s->td_swap.tv_nsec / 1000000000.0)) / std::max(1, s->frame_count);
+        s->frame_count = 0;
+        s->td_swap = 0_s;
+        if (gpu_stats_show) {
+            jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "surface %u: fps %f, swap %fms/frame\n",
+                            s->info.window_id, ss.fps, ss.swap_costs * 1000.0);  // window_id is immutable
+        }
+        s->stats.publish();
+    }
+    gpu_frame_histogram.clear();
+    gpu_frames_over_budget = 0;
+    input_latency_histogram.clear();
+    input_latency_over_budget = 0;
+    gpu_fps_t0 = gpu_swap_t1;
+    gpu_stats_frame_count = 0;
+    td_net_costs = 0_s;
+    td_slept = 0_s;
+}
+
+int64_t gamp::impl::take_input_latency_t0() noexcept {
+    const int64_t t0_ns = input_latency_t0_ns;
+    input_latency_t0_ns = 0;
+    return t0_ns;
+}
+
 void gamp::swap_gpu_buffer(int fps) noexcept {
-    SDL_GL_SwapWindow(sdl_win);
+    impl::present_frame(fps, impl::take_input_latency_t0());
+}
+
+void gamp::impl::present_frame(int fps, int64_t input_t0_ns) noexcept {
+    const jau::fraction_timespec t_work_end = jau::getMonotonicTime();
+    {
+        GAMP_PROFILE_ZONE("swap_gpu_buffer");
+        if (!surfaces.empty()) {
+            present_surfaces();
+        }
+        impl::gpu_timer_end_frame();
+        if (gfx_headless) {
+            glFinish();
+        } else {
+            SDL_GL_SwapWindow(sdl_win);
+        }
+    }
+    GAMP_PROFILE_FRAME_MARK("frame");
+    if (!impl::render_thread_active()) {
+        impl::input_record_end_frame();  // otherwise marked by the event thread's submit_render_frame()
+    }
     jau::fraction_timespec gpu_swap_t1 = jau::getMonotonicTime();
     const jau::fraction_timespec td_last_frame = gpu_swap_t1 - gpu_swap_t0;
     td_net_costs += td_last_frame;
     ++gpu_stats_frame_count;
-    const jau::fraction_timespec td = gpu_swap_t1 - gpu_fps_t0;
-    if (td >= gpu_stats_period) {
-        const double gpu_frame_count_d = gpu_stats_frame_count;
-        gpu_stats_fps = (float)gpu_stats_frame_count / ((float)td.tv_sec + ((float)td.tv_nsec / 1000000000.0f));
-        gpu_stats_frame_costs_in_sec = ((double)td_net_costs.tv_sec + ((double)td_net_costs.tv_nsec / 1000000000.0f)) / gpu_frame_count_d;
-        gpu_stats_frame_slept_in_sec = ((double)td_slept.tv_sec + ((double)td_slept.tv_nsec / 1000000000.0f)) / gpu_frame_count_d;
-        if (gpu_stats_show) {
-            jau::fprintf_td(gpu_swap_t1.to_ms(), stdout, "fps: %f (req %d), frames %d, td %s, costs %fms/frame, slept %fms/frame\n",
-                            gpu_stats_fps, fps, gpu_stats_frame_count, td.to_string().c_str(), gpu_stats_frame_costs_in_sec * 1000.0, gpu_stats_frame_slept_in_sec * 1000.0);
-        }
-        gpu_fps_t0 = gpu_swap_t1;
-        gpu_stats_frame_count = 0;
-        td_net_costs = 0_s;
-        td_slept = 0_s;
-    }
-    if (0 < fps) {
-        const jau::fraction_timespec fudge(1_ms / 4_i64);
-        // const int64_t fudge_ns = gamp::NanoPerMilli / 4;
-        // const uint64_t ms_per_frame = (uint64_t)std::round(1000.0 / fps);
-        const jau::fraction_timespec td_per_frame(1_s / (int64_t)fps);
-        const jau::fraction_timespec tdd = td_per_frame - td_last_frame;
-        if (tdd > fudge) {
-            jau::sleep(tdd, false);  // allow IRQ
-            td_slept += tdd;
-            // gpu_swap_t0 += tdd; // accurate enough?
-            gpu_swap_t0 = jau::getMonotonicTime();
-            // jau::fprintf_td(gpu_swap_t0.to_ms(), stdout, "soft-sync.1 [exp %" PRIi64 " > has %" PRIi64 "]us, delay %" PRIi64 "us\n",
-            //                 td_per_frame.to_us(), td_this_frame.to_us(), tdd.to_us());
-        } else {
-            gpu_swap_t0 = gpu_swap_t1;
+    const int base_fps = 0 < fps ? fps : display_frames_per_sec;
+    const bool governed = fps_gov_enabled && 0 < base_fps;
+    const int budget_fps = governed ? std::max(1, base_fps / fps_gov_divisor.load(std::memory_order_relaxed)) : base_fps;
+    const uint64_t gpu_us = impl::gpu_timer_begin_frame(budget_fps);
+    {
+        const int64_t work_us = (t_work_end - gpu_swap_t0).to_us();
+        const uint64_t cost_us = std::max(static_cast<uint64_t>(std::max<int64_t>(0, work_us)), gpu_us);
+        if (governed) {
+            fps_gov_update(cost_us, base_fps, fps);
         }
+        impl::dynamic_resolution_update(cost_us, budget_fps);
+    }
+    if (0 != input_t0_ns) {
+        const int64_t latency_us = std::max<int64_t>(0, (to_ns(gpu_swap_t1) - input_t0_ns) / 1000);
+        input_latency_histogram.add(static_cast<uint64_t>(latency_us));
+        if (0 < budget_fps && latency_us * budget_fps > 2000000) {  // latency_us > 2 * 1000000 / budget_fps
+            ++input_latency_over_budget;
+        }
+    }
+    {
+        const int64_t frame_us = (gpu_swap_t1 - gpu_swap_t1_last).to_us();
+        gpu_swap_t1_last = gpu_swap_t1;
+        gpu_frame_histogram.add(static_cast<uint64_t>(frame_us));
+        gpu_frame_times.add(static_cast<uint64_t>(frame_us));
+        gpu_frame_times_pub.publish(gpu_frame_times);
+        if (0 < budget_fps && frame_us * budget_fps * 2 > 3000000) {  // frame_us > 1.5 * 1000000 / budget_fps
+            ++gpu_frames_over_budget;
+        }
+    }
+    if (gpu_stats_end_requested.exchange(false, std::memory_order_acq_rel) || gpu_swap_t1 - gpu_fps_t0 >= gpu_stats_period) {
+        end_stats_period(gpu_swap_t1, fps, budget_fps);
+    }
+    if (governed && 1 < fps_gov_divisor.load(std::memory_order_relaxed) && !fps_gov_swap_interval) {
+        pace_frame(gpu_swap_t1, budget_fps);
+    } else if (0 < fps) {
+        pace_frame(gpu_swap_t1, fps);
     } else {
+        pacer_fps = 0;
         gpu_swap_t0 = jau::getMonotonicTime();
     }
 }
 
+/** Returns the latest published statistics, acquiring them if new. To be called on one thread only, see triple_buffer_t. */
+static const gpu_stats_t& gpu_stats_latest() noexcept {
+    gpu_stats.update();
+    return gpu_stats.front();
+}
+
 float gamp::get_gpu_stats_fps() noexcept {
-    return gpu_stats_fps;
+    return gpu_stats_latest().fps;
 }
 
 double gamp::get_gpu_stats_frame_costs() noexcept {
-    return gpu_stats_frame_costs_in_sec;
+    return gpu_stats_latest().frame_costs_in_sec;
 }
 double gamp::get_gpu_stats_frame_sleep() noexcept {
-    return gpu_stats_frame_slept_in_sec;
+    return gpu_stats_latest().frame_slept_in_sec;
+}
+duration_percentiles_t gamp::get_gpu_stats_frame_percentiles() noexcept {
+    return gpu_stats_latest().frame_pct;
+}
+duration_percentiles_t gamp::get_gpu_stats_input_latency_percentiles() noexcept {
+    return gpu_stats_latest().input_latency_pct;
+}
+double gamp::get_gpu_stats_gpu_costs() noexcept {
+    return gpu_stats_latest().gpu_costs_in_sec;
+}
+duration_percentiles_t gamp::get_gpu_stats_gpu_percentiles() noexcept {
+    return gpu_stats_latest().gpu_pct;
+}
+size_t gamp::get_gpu_stats_frame_times(std::span<uint32_t> dest) noexcept {
+    gpu_frame_times_pub.update();
+    return gpu_frame_times_pub.front().copy_to(dest);
 }
 
 void gamp::set_gpu_stats_period(int64_t milliseconds) noexcept {
@@ -284,178 +945,530 @@ void gamp::set_gpu_stats_period(int64_t milliseconds) noexcept {
 int64_t gamp::get_gpu_stats_period() noexcept {
     return gpu_stats_period.to_ms();
 }
+void gamp::end_gpu_stats_period() noexcept {
+    if (impl::render_thread_active()) {
+        gpu_stats_end_requested.store(true, std::memory_order_release);  // the render thread owns the period's accumulation
+        return;
+    }
+    const int base_fps = 0 < forced_fps ? forced_fps : display_frames_per_sec;
+    const int budget_fps = fps_gov_enabled && 0 < base_fps ? std::max(1, base_fps / fps_gov_divisor.load(std::memory_order_relaxed)) : base_fps;
+    end_stats_period(jau::getMonotonicTime(), forced_fps, budget_fps);
+}
+void gamp::set_fps_governor(bool enable) noexcept {
+    if (enable != fps_gov_enabled) {
+        fps_gov_enabled = enable;
+        fps_gov_switches.store(0, std::memory_order_relaxed);
+        fps_gov_histogram.clear();
+        fps_gov_window_frames = 0;
+        fps_gov_set_divisor(1, forced_fps);
+    }
+}
+bool gamp::get_fps_governor() noexcept {
+    return fps_gov_enabled;
+}
+int gamp::get_fps_governor_divisor() noexcept {
+    return fps_gov_enabled ? fps_gov_divisor.load(std::memory_order_relaxed) : 1;
+}
+uint64_t gamp::get_fps_governor_switches() noexcept {
+    return fps_gov_switches.load(std::memory_order_relaxed);
+}
 void gamp::set_gpu_stats_show(bool enable) noexcept {
     gpu_stats_show = enable;
 }
 
-static input_event_type_t to_event_type(SDL_Scancode scancode) {
-    switch (scancode) {
-        case SDL_SCANCODE_ESCAPE:
-            return input_event_type_t::WINDOW_CLOSE_REQ;
-        case SDL_SCANCODE_P:
-            return input_event_type_t::PAUSE;
-        case SDL_SCANCODE_UP:
-            return input_event_type_t::P1_UP;
-        case SDL_SCANCODE_LEFT:
-            return input_event_type_t::P1_LEFT;
-        case SDL_SCANCODE_DOWN:
-            return input_event_type_t::P1_DOWN;
-        case SDL_SCANCODE_RIGHT:
-            return input_event_type_t::P1_RIGHT;
-        case SDL_SCANCODE_RSHIFT:
-            return input_event_type_t::P1_ACTION1;
-        case SDL_SCANCODE_RETURN:
-            return input_event_type_t::P1_ACTION2;
-        case SDL_SCANCODE_RALT:
-            return input_event_type_t::P1_ACTION3;
-            /**
-        case SDL_SCANCODE_RGUI:
-            return input_event_type_t::P1_ACTION4; */
-        case SDL_SCANCODE_W:
-            return input_event_type_t::P2_UP;
-        case SDL_SCANCODE_A:
-            return input_event_type_t::P2_LEFT;
-        case SDL_SCANCODE_S:
-            return input_event_type_t::P2_DOWN;
-        case SDL_SCANCODE_D:
-            return input_event_type_t::P2_RIGHT;
-        case SDL_SCANCODE_LSHIFT:
-            return input_event_type_t::P2_ACTION1;
-        case SDL_SCANCODE_LCTRL:
-            return input_event_type_t::P2_ACTION2;
-        case SDL_SCANCODE_LALT:
-            return input_event_type_t::P2_ACTION3;
-            /**
-        case SDL_SCANCODE_LGUI:
-            return input_event_type_t::P2_ACTION4; */
-        case SDL_SCANCODE_R:
-            return input_event_type_t::RESET;
-        default:
-            return input_event_type_t::NONE;
-    }
-}
-static uint16_t to_ascii(SDL_Scancode scancode) {
-    if (SDL_SCANCODE_A <= scancode && scancode <= SDL_SCANCODE_Z) {
-        return 'a' + (scancode - SDL_SCANCODE_A);
-    }
-    if (SDL_SCANCODE_1 <= scancode && scancode <= SDL_SCANCODE_9) {
-        return '1' + (scancode - SDL_SCANCODE_1);
-    }
-    if (SDL_SCANCODE_0 == scancode) {
-        return '0' + (scancode - SDL_SCANCODE_0);
-    }
-    switch (scancode) {
-        case SDL_SCANCODE_SEMICOLON:
-            return ';';
-
-        case SDL_SCANCODE_MINUS:
-            [[fallthrough]];
-        case SDL_SCANCODE_KP_MINUS:
-            return '-';
+/**
+ * Converts given SDL event timestamp, milliseconds since SDL initialization, to monotonic time
+ * by subtracting the event's age from now.
+ */
+static jau::fraction_timespec to_monotonic_time(Uint32 sdl_timestamp) noexcept {
+    const jau::fraction_timespec now = jau::getMonotonicTime();
+    const Uint32 age_ms = SDL_GetTicks() - sdl_timestamp;  // wrap-around safe
+    if (age_ms > 10000) {
+        return now;  // bogus timestamp
+    }
+    return now - jau::fraction_timespec(1_ms * static_cast<int64_t>(age_ms));
+}
 
-        case SDL_SCANCODE_KP_PLUS:
-            return '+';
+/** Tracks the oldest input pending presentation, see impl::take_input_latency_t0(). */
+static void on_input_event(const jau::fraction_timespec& timestamp) noexcept {
+    const int64_t ns = to_ns(timestamp);
+    if (0 == input_latency_t0_ns || ns < input_latency_t0_ns) {
+        input_latency_t0_ns = ns;
+    }
+}
 
-        case SDL_SCANCODE_KP_MULTIPLY:
-            return '*';
+/** Converts given SDL event to event_t, returns false if not handled. */
+static bool to_event(const SDL_Event& sdl_event, event_t& e) noexcept {
+    switch (sdl_event.type) {
+        case SDL_QUIT:
+            e.type = input_event_type_t::WINDOW_CLOSE_REQ;
+            e.timestamp = to_monotonic_time(sdl_event.common.timestamp);
+            return true;
 
-        case SDL_SCANCODE_SLASH:
-            [[fallthrough]];
-        case SDL_SCANCODE_KP_DIVIDE:
-            return '/';
+        case SDL_WINDOWEVENT:
+            switch (sdl_event.window.event) {
+                case SDL_WINDOWEVENT_SHOWN:
+                    // log_printf("Window Shown\n");
+                    break;
+                case SDL_WINDOWEVENT_HIDDEN:
+                    // log_printf("Window Hidden\n");
+                    break;
+                case SDL_WINDOWEVENT_CLOSE:
+                    // SDL_QUIT is only sent after closing the last window, i.e. needed for the primary window with surfaces only
+                    e.window_id = to_window_id(sdl_event.window.windowID);
+                    if (0 == e.window_id && surfaces.empty()) {
+                        break;
+                    }
+                    e.type = input_event_type_t::WINDOW_CLOSE_REQ;
+                    e.timestamp = to_monotonic_time(sdl_event.window.timestamp);
+                    return true;
+                case SDL_WINDOWEVENT_RESIZED:
+                    e.window_id = to_window_id(sdl_event.window.windowID);
+                    e.type = input_event_type_t::WINDOW_RESIZED;
+                    e.x = sdl_event.window.data1;
+                    e.y = sdl_event.window.data2;
+                    e.timestamp = to_monotonic_time(sdl_event.window.timestamp);
+                    return true;
+                case SDL_WINDOWEVENT_SIZE_CHANGED:
+                    log_printf(log_level_t::trace, "Window SizeChanged: %d x %d\n", sdl_event.window.data1, sdl_event.window.data2);
+                    break;
 
-        case SDL_SCANCODE_KP_PERCENT:
-            return '%';
+                default: break;
+            }
+            return false;
 
-        case SDL_SCANCODE_KP_LEFTPAREN:
-            [[fallthrough]];
-        case SDL_SCANCODE_KP_LEFTBRACE:
+        case SDL_MOUSEMOTION:
+            if (SDL_TOUCH_MOUSEID == sdl_event.motion.which) {
+                return false;  // synthesized from touch, handled as SDL_FINGERMOTION
+            }
+            e.window_id = to_window_id(sdl_event.motion.windowID);
+            e.type = input_event_type_t::POINTER_MOTION;
+            e.id = (int32_t)sdl_event.motion.which;
+            e.x = sdl_event.motion.x;
+            e.y = sdl_event.motion.y;
+            e.dx = sdl_event.motion.xrel;
+            e.dy = sdl_event.motion.yrel;
+            e.pressure = 0 != sdl_event.motion.state ? 1.0f : 0.0f;
+            e.timestamp = to_monotonic_time(sdl_event.motion.timestamp);
+            return true;
+
+        case SDL_MOUSEBUTTONDOWN:
             [[fallthrough]];
-        case SDL_SCANCODE_LEFTBRACKET:
-            return '(';
+        case SDL_MOUSEBUTTONUP:
+            if (SDL_TOUCH_MOUSEID == sdl_event.button.which) {
+                return false;  // synthesized from touch, handled as SDL_FINGERDOWN or SDL_FINGERUP
+            }
+            e.window_id = to_window_id(sdl_event.button.windowID);
+            e.type = input_event_type_t::POINTER_BUTTON;
+            e.id = (int32_t)sdl_event.button.which;
+            e.button = sdl_event.button.button;
+            e.down = SDL_MOUSEBUTTONDOWN == sdl_event.type;
+            e.x = sdl_event.button.x;
+            e.y = sdl_event.button.y;
+            e.pressure = e.down ? 1.0f : 0.0f;
+            e.timestamp = to_monotonic_time(sdl_event.button.timestamp);
+            return true;
 
-        case SDL_SCANCODE_KP_RIGHTPAREN:
+        case SDL_FINGERMOTION:
             [[fallthrough]];
-        case SDL_SCANCODE_KP_RIGHTBRACE:
+        case SDL_FINGERDOWN:
             [[fallthrough]];
-        case SDL_SCANCODE_RIGHTBRACKET:
-            return ')';
+        case SDL_FINGERUP:
+            // normalized [0..1] finger position
+            e.window_id = to_window_id(sdl_event.tfinger.windowID);
+            e.type = SDL_FINGERMOTION == sdl_event.type ? input_event_type_t::POINTER_MOTION : input_event_type_t::POINTER_BUTTON;
+            e.pointer_type = pointer_type_t::touch;
+            e.id = static_cast<int32_t>(sdl_event.tfinger.fingerId & 0x7fffffff);
+            e.button = 1;
+            e.down = SDL_FINGERUP != sdl_event.type;
+            e.x = static_cast<int32_t>(sdl_event.tfinger.x * static_cast<float>(event_win_width));
+            e.y = static_cast<int32_t>(sdl_event.tfinger.y * static_cast<float>(event_win_height));
+            // delta of the converted positions, avoiding truncation of small normalized deltas
+            e.dx = e.x - static_cast<int32_t>((sdl_event.tfinger.x - sdl_event.tfinger.dx) * static_cast<float>(event_win_width));
+            e.dy = e.y - static_cast<int32_t>((sdl_event.tfinger.y - sdl_event.tfinger.dy) * static_cast<float>(event_win_height));
+            e.pressure = sdl_event.tfinger.pressure;
+            e.timestamp = to_monotonic_time(sdl_event.tfinger.timestamp);
+            return true;
 
-        case SDL_SCANCODE_COMMA:
-            return ',';
+        case SDL_CONTROLLERDEVICEADDED:
+            [[fallthrough]];
+        case SDL_CONTROLLERDEVICEREMOVED:
+            impl::on_controller_hotplug();
+            return false;
+
+        case SDL_TEXTINPUT:
+            e.window_id = to_window_id(sdl_event.text.windowID);
+            e.type = input_event_type_t::TEXT_INPUT;
+            std::copy_n(sdl_event.text.text, e.text.size() - 1, e.text.data());  // e.text is zero filled
+            e.timestamp = to_monotonic_time(sdl_event.text.timestamp);
+            return true;
 
-        case SDL_SCANCODE_PERIOD:
-            return '.';
+        case SDL_TEXTEDITING:
+            e.window_id = to_window_id(sdl_event.edit.windowID);
+            e.type = input_event_type_t::TEXT_EDITING;
+            std::copy_n(sdl_event.edit.text, e.text.size() - 1, e.text.data());
+            e.x = sdl_event.edit.start;
+            e.y = sdl_event.edit.length;
+            e.timestamp = to_monotonic_time(sdl_event.edit.timestamp);
+            return true;
 
-        case SDL_SCANCODE_SPACE:
+        case SDL_KEYUP:
             [[fallthrough]];
-        case SDL_SCANCODE_TAB:
-            return ' ';
+        case SDL_KEYDOWN: {
+            const SDL_Scancode scancode = sdl_event.key.keysym.scancode;
+            e.window_id = to_window_id(sdl_event.key.windowID);
+            e.type = SDL_KEYDOWN == sdl_event.type ? input_event_type_t::ANY_KEY_DOWN : input_event_type_t::ANY_KEY_UP;
+            e.action = impl::key_action(scancode);
+            e.key_code = impl::key_ascii(scancode);
+            e.timestamp = to_monotonic_time(sdl_event.key.timestamp);
+            //       printf("%d", scancode);
+            return true;
+        }
 
-        case SDL_SCANCODE_RETURN:
+        default: return false;
+    }
+}
+
+/** Handles the toolkit side of given event_t, to be called on the rendering thread. */
+static void on_event(const event_t& e) noexcept {
+    switch (e.type) {
+        case input_event_type_t::WINDOW_CLOSE_REQ:
+            log_printf(log_level_t::info, "Window Close Requested\n");
+            break;
+        case input_event_type_t::WINDOW_RESIZED:
+            // applied once per frame via apply_window_resize(), recorded by on_event_watch()
+            log_printf(log_level_t::trace, "Window Resized: %d x %d\n", e.x, e.y);
+            break;
+        case input_event_type_t::POINTER_MOTION:
+            [[fallthrough]];
+        case input_event_type_t::POINTER_BUTTON:
+            [[fallthrough]];
+        case input_event_type_t::ANY_KEY_UP:
             [[fallthrough]];
-        case SDL_SCANCODE_KP_ENTER:
-            return '\n';
+        case input_event_type_t::ANY_KEY_DOWN:
+            [[fallthrough]];
+        case input_event_type_t::TEXT_INPUT:
+            on_input_event(e.timestamp);
+            break;
+        default: break;
+    }
+}
 
-        case SDL_SCANCODE_BACKSPACE:
-            return 0x08;
+/** True if the next handle_one_event() starts a new frame, i.e. the previous call returned false. */
+static bool one_event_begin_frame = true;
 
-        default:
+bool gamp::handle_one_event(input_event_t& event) noexcept {
+    if (one_event_begin_frame) {
+        event.begin_frame();
+        one_event_begin_frame = false;
+    }
+    event_t e;
+    if (0 < poll_events(std::span<event_t>(&e, 1))) {
+        if (input_event_type_t::WINDOW_RESIZED == e.type) {
+            apply_window_resize();
+        }
+        event.apply(e);
+        return true;
+    } else {
+        one_event_begin_frame = true;
+        return false;
+    }
+}
+
+static bool event_pump_enabled = false;
+static spsc_ring_t<event_t, event_queue_capacity> event_queue;
+static std::atomic<uint64_t> event_queue_dropped{0};
+/** Most recent pointer position of the primary window seen by pump_events() for latch_pointer_motion(), x in upper and y in lower 32 bits. */
+static std::atomic<uint64_t> event_pump_pointer{UINT64_MAX};
+
+void gamp::set_event_pump(bool enable) noexcept {
+    event_pump_enabled = enable;
+}
+bool gamp::get_event_pump() noexcept {
+    return event_pump_enabled;
+}
+uint64_t gamp::get_event_pump_dropped() noexcept {
+    return event_queue_dropped.load(std::memory_order_relaxed);
+}
+
+/** Converts and queues given SDL event, returns true if queued. */
+static bool queue_event(const SDL_Event& sdl_event) noexcept {
+    event_t e;
+    if (!to_event(sdl_event, e)) {
+        return false;
+    }
+    if (input_event_type_t::POINTER_MOTION == e.type && 0 == e.window_id) {
+        event_pump_pointer.store(static_cast<uint64_t>(static_cast<uint32_t>(e.x)) << 32 | static_cast<uint32_t>(e.y),
+                                 std::memory_order_release);
+    }
+    // Headroom keeps room for window events and presses while flooded by motion, i.e. motion is dropped first
+    size_t reserve = 0;
+    if (input_event_type_t::POINTER_MOTION == e.type) {
+        reserve = event_queue_capacity / 4;
+    } else if (input_event_type_t::WINDOW_CLOSE_REQ != e.type && input_event_type_t::WINDOW_RESIZED != e.type) {
+        reserve = event_queue_capacity / 16;
+    }
+    if (event_queue.size() + reserve >= event_queue_capacity || !event_queue.push(e)) {
+        event_queue_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+size_t gamp::pump_events(int timeout_ms) noexcept {
+    GAMP_PROFILE_ZONE("pump_events");
+    constexpr int batch_size = 64;
+    SDL_Event sdl_events[batch_size];
+    size_t count = 0;
+    if (0 < timeout_ms) {
+        if (0 == SDL_WaitEventTimeout(&sdl_events[0], timeout_ms)) {
             return 0;
+        }
+        count += queue_event(sdl_events[0]) ? 1 : 0;
     }
-    return 0;
+    SDL_PumpEvents();
+    int n;
+    while (0 < (n = SDL_PeepEvents(sdl_events, batch_size, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT))) {
+        for (int i = 0; i < n; ++i) {
+            count += queue_event(sdl_events[i]) ? 1 : 0;
+        }
+    }
+    return count;
 }
 
-bool gamp::handle_one_event(input_event_t& event) noexcept {
-    SDL_Event sdl_event;
-
-    if (SDL_PollEvent(&sdl_event)) {
-        switch (sdl_event.type) {
-            case SDL_QUIT:
-                event.set(input_event_type_t::WINDOW_CLOSE_REQ);
-                printf("Window Close Requested\n");
-                break;
-
-            case SDL_WINDOWEVENT:
-                switch (sdl_event.window.event) {
-                    case SDL_WINDOWEVENT_SHOWN:
-                        // log_printf("Window Shown\n");
-                        break;
-                    case SDL_WINDOWEVENT_HIDDEN:
-                        // log_printf("Window Hidden\n");
-                        break;
-                    case SDL_WINDOWEVENT_RESIZED:
-                        printf("Window Resized: %d x %d\n", sdl_event.window.data1, sdl_event.window.data2);
-                        event.set(input_event_type_t::WINDOW_RESIZED);
-                        on_window_resized(sdl_event.window.data1, sdl_event.window.data2);
-                        break;
-                    case SDL_WINDOWEVENT_SIZE_CHANGED:
-                        printf("Window SizeChanged: %d x %d\n", sdl_event.window.data1, sdl_event.window.data2);
-                        break;
-                        
-                    default: break;
+/** Fills given array with live events, i.e. from the event queue in pump mode or the toolkit, not yet passed to on_event(). */
+static size_t poll_live_events(std::span<event_t> events) noexcept {
+    size_t count = 0;
+    if (event_pump_enabled) {
+        while (count < events.size() && event_queue.pop(events[count])) {
+            ++count;
+        }
+        return count;
+    }
+    constexpr size_t batch_size = 64;
+    SDL_Event sdl_events[batch_size];
+    SDL_PumpEvents();
+    while (count < events.size()) {
+        const int n = SDL_PeepEvents(sdl_events, static_cast<int>(std::min(batch_size, events.size() - count)),
+                                     SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+        if (0 >= n) {
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            event_t& e = events[count];
+            e = event_t();
+            if (to_event(sdl_events[i], e)) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+size_t gamp::poll_events(std::span<event_t> events) noexcept {
+    size_t count = 0;
+    if (impl::input_replay_active()) {
+        // Live input is replaced by the replay, only window close requests and resizes pass.
+        // Polls no more live events than room is left, the remaining ones stay queued for the next call.
+        std::array<event_t, 64> live;
+        size_t n;
+        while (count < events.size() &&
+               0 < (n = poll_live_events(std::span<event_t>(live).first(std::min(live.size(), events.size() - count))))) {
+            for (size_t i = 0; i < n; ++i) {
+                const event_t& e = live[i];
+                if (input_event_type_t::WINDOW_CLOSE_REQ == e.type || input_event_type_t::WINDOW_RESIZED == e.type) {
+                    on_event(e);
+                    events[count++] = e;
+                }
+            }
+        }
+        const size_t r = impl::input_replay_poll(events.subspan(count));
+        for (size_t i = count; i < count + r; ++i) {
+            on_event(events[i]);
+        }
+        return count + r;
+    }
+    count = poll_live_events(events);
+    for (size_t i = 0; i < count; ++i) {
+        on_event(events[i]);
+        impl::input_record(events[i]);
+    }
+    return count;
+}
+
+static bool motion_coalescing = false;
+
+void gamp::set_motion_coalescing(bool enable) noexcept {
+    motion_coalescing = enable;
+}
+bool gamp::get_motion_coalescing() noexcept {
+    return motion_coalescing;
+}
+
+bool gamp::set_relative_mouse_mode(bool enable) noexcept {
+    if (0 != SDL_SetRelativeMouseMode(enable ? SDL_TRUE : SDL_FALSE)) {
+        printf("SDL: Error setting relative mouse mode: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+bool gamp::get_relative_mouse_mode() noexcept {
+    return SDL_TRUE == SDL_GetRelativeMouseMode();
+}
+
+void gamp::start_text_input() noexcept {
+    SDL_StartTextInput();
+}
+void gamp::stop_text_input() noexcept {
+    SDL_StopTextInput();
+}
+bool gamp::is_text_input_active() noexcept {
+    return SDL_TRUE == SDL_IsTextInputActive();
+}
+void gamp::set_text_input_rect(const jau::math::Recti& r) noexcept {
+    SDL_Rect sr = { r.x(), r.y(), r.width(), r.height() };
+    SDL_SetTextInputRect(&sr);
+}
+
+namespace {
+    /** Per frame coalesced pointer motion of drain_events(), one per pointer. */
+    class motion_coalescer_t {
+        private:
+            std::array<event_t, pointer_state_t::capacity> m_pending;
+            size_t m_count = 0;
+
+            static bool same_pointer(const event_t& a, const event_t& b) noexcept {
+                return a.pointer_type == b.pointer_type && a.id == b.id;
+            }
+
+        public:
+            /** Folds given motion into the pending motion of its pointer, applies it directly if capacity is exceeded. */
+            void add(input_event_t& event, const event_t& e) noexcept {
+                for (size_t i = 0; i < m_count; ++i) {
+                    event_t& p = m_pending[i];
+                    if (same_pointer(p, e)) {
+                        const int32_t dx = p.dx + e.dx, dy = p.dy + e.dy;
+                        p = e;
+                        p.dx = dx;
+                        p.dy = dy;
+                        return;
+                    }
+                }
+                if (m_count < m_pending.size()) {
+                    m_pending[m_count++] = e;
+                } else {
+                    event.apply(e);
+                }
+            }
+            /** Applies and removes the pending motion of given event's pointer, if any. */
+            void flush(input_event_t& event, const event_t& e) noexcept {
+                for (size_t i = 0; i < m_count; ++i) {
+                    if (same_pointer(m_pending[i], e)) {
+                        event.apply(m_pending[i]);
+                        for (size_t j = i + 1; j < m_count; ++j) {
+                            m_pending[j - 1] = m_pending[j];
+                        }
+                        --m_count;
+                        return;
+                    }
+                }
+            }
+            /** Applies and removes all pending motion in order of their first arrival. */
+            void flush_all(input_event_t& event) noexcept {
+                for (size_t i = 0; i < m_count; ++i) {
+                    event.apply(m_pending[i]);
+                }
+                m_count = 0;
+            }
+    };
+}  // namespace
+
+size_t gamp::drain_events(input_event_t& event) noexcept {
+    GAMP_PROFILE_ZONE("drain_events");
+    std::array<event_t, 64> events;
+    motion_coalescer_t coalescer;
+    size_t count = 0;
+    size_t n;
+    event.begin_frame();
+    while (0 < (n = poll_events(events))) {
+        for (size_t i = 0; i < n; ++i) {
+            const event_t& e = events[i];
+            if (input_event_type_t::POINTER_MOTION == e.type) {
+                event.pointers.add_sample(e.pointer_type, e.id, e.x, e.y, e.pressure, e.timestamp);
+                if (motion_coalescing) {
+                    coalescer.add(event, e);
+                    continue;
                 }
-                break;
-
-            case SDL_MOUSEMOTION:
-                event.pointer_motion((int)sdl_event.motion.which,
-                                     (int)sdl_event.motion.x, (int)sdl_event.motion.y);
-                break;
-            case SDL_KEYUP: {
-                const SDL_Scancode scancode = sdl_event.key.keysym.scancode;
-                event.clear(to_event_type(scancode), to_ascii(scancode));
-            } break;
-
-            case SDL_KEYDOWN: {
-                const SDL_Scancode scancode = sdl_event.key.keysym.scancode;
-                event.set(to_event_type(scancode), to_ascii(scancode));
-                //       printf("%d", scancode);
-            } break;
-            
-            default: break;
+            } else if (input_event_type_t::POINTER_BUTTON == e.type) {
+                coalescer.flush(event, e);
+            }
+            event.apply(e);
+        }
+        count += n;
+    }
+    coalescer.flush_all(event);
+    apply_window_resize();
+    if (get_input_snapshot_publish()) {
+        input_snapshot_t& snapshot = input_snapshot();
+        snapshot.back() = event;
+        snapshot.publish_merged([](input_event_t& newer, const input_event_t& older) noexcept { newer.merge_previous(older); });
+    }
+    return count;
+}
+
+/** Peek buffer of latch_pointer_motion(), grown to the number of queued motion events. Used on the thread polling events only. */
+static std::vector<SDL_Event> latch_events;
+
+/** Returns the newest queued motion event of given SDL event type of the primary window without consuming it, false if none. */
+static bool peek_latest_motion(Uint32 type, event_t& latest) noexcept {
+    const int n = SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, type, type);  // counts all queued events of type
+    if (0 >= n) {
+        return false;
+    }
+    if (latch_events.size() < static_cast<size_t>(n)) {
+        latch_events.resize(static_cast<size_t>(n));
+    }
+    const int m = SDL_PeepEvents(latch_events.data(), n, SDL_PEEKEVENT, type, type);
+    for (int i = m - 1; i >= 0; --i) {
+        event_t e;
+        if (to_event(latch_events[static_cast<size_t>(i)], e) && 0 == e.window_id) {
+            latest = e;
+            return true;
         }
+    }
+    return false;
+}
+
+bool gamp::latch_pointer_motion(input_event_t& event) noexcept {
+    GAMP_PROFILE_ZONE("latch_pointer_motion");
+    if (impl::input_replay_active()) {
+        return false;  // live pointer motion would break the deterministic replay
+    }
+    if (event_pump_enabled) {
+        // The queued motion events are applied in order by the next drain_events(), ending at the same position
+        const uint64_t v = event_pump_pointer.load(std::memory_order_acquire);
+        if (UINT64_MAX == v) {
+            return false;
+        }
+        const int x = static_cast<int32_t>(static_cast<uint32_t>(v >> 32));
+        const int y = static_cast<int32_t>(static_cast<uint32_t>(v));
+        if (x == event.pointer_x && y == event.pointer_y) {
+            return false;
+        }
+        event.pointer_motion(event.pointer_id, x, y);
         return true;
-    } else {
+    }
+    // Peek the whole queue without consuming, all events are applied in order by the next handle_events()
+    SDL_PumpEvents();
+    event_t latest, finger;
+    bool found = peek_latest_motion(SDL_MOUSEMOTION, latest);
+    if (peek_latest_motion(SDL_FINGERMOTION, finger) && (!found || finger.timestamp > latest.timestamp)) {
+        latest = finger;
+        found = true;
+    }
+    if (!found || (latest.x == event.pointer_x && latest.y == event.pointer_y)) {
         return false;
     }
+    event.pointer_motion(latest.id, latest.x, latest.y);
+    return true;
 }
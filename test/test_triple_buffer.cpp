@@ -0,0 +1,158 @@
+/*
+ * Author: Sven Gothel <sgothel@jausoft.com> and Svenson Han Gothel
+ * Copyright (c) 2022-2024 Gothel Software e.K.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cstdint>
+#include <thread>
+
+#include <jau/test/catch2_ext.hpp>
+
+#include <gamp/gamp.hpp>
+#include <gamp/triple_buffer.hpp>
+
+using namespace gamp;
+
+namespace {
+    /** Per frame value, merged frames accumulate sum and count while keeping the newest last value. */
+    struct frame_acc_t {
+        uint64_t sum = 0;
+        uint64_t count = 0;
+        uint64_t last = 0;
+    };
+
+    void set_frame(frame_acc_t& f, uint64_t v) noexcept {
+        f.sum = v;
+        f.count = 1;
+        f.last = v;
+    }
+
+    void merge_frame(frame_acc_t& newer, const frame_acc_t& older) noexcept {
+        newer.sum += older.sum;
+        newer.count += older.count;
+    }
+}
+
+TEST_CASE("Triple Buffer Test 01 - Publish Latest", "[triple_buffer]") {
+    triple_buffer_t<int> tb;
+    REQUIRE(false == tb.update());
+    REQUIRE(0 == tb.sequence());
+
+    tb.publish(1);
+    tb.publish(2);
+    REQUIRE(true == tb.update());
+    REQUIRE(2 == tb.front());
+    REQUIRE(2 == tb.sequence());
+    REQUIRE(false == tb.update());
+    REQUIRE(2 == tb.front());
+}
+
+TEST_CASE("Triple Buffer Test 02 - Merge Once", "[triple_buffer]") {
+    triple_buffer_t<frame_acc_t> tb;
+
+    // 1 and 2 not acquired, merged into 4
+    set_frame(tb.back(), 1); tb.publish_merged(merge_frame);
+    set_frame(tb.back(), 2); tb.publish_merged(merge_frame);
+    set_frame(tb.back(), 4); tb.publish_merged(merge_frame);
+    REQUIRE(true == tb.update());
+    REQUIRE(7 == tb.front().sum);
+    REQUIRE(3 == tb.front().count);
+    REQUIRE(4 == tb.front().last);
+    REQUIRE(3 == tb.sequence());
+    REQUIRE(false == tb.update());
+
+    // 4 has been acquired, not merged again
+    set_frame(tb.back(), 8); tb.publish_merged(merge_frame);
+    REQUIRE(true == tb.update());
+    REQUIRE(8 == tb.front().sum);
+    REQUIRE(1 == tb.front().count);
+    REQUIRE(8 == tb.front().last);
+    REQUIRE(4 == tb.sequence());
+    REQUIRE(false == tb.update());
+}
+
+TEST_CASE("Triple Buffer Test 03 - No Lost Frame Concurrently", "[triple_buffer]") {
+    constexpr uint64_t frames = 1000000;
+    triple_buffer_t<frame_acc_t> tb;
+
+    std::thread producer([&tb]() {
+        for (uint64_t v = 1; v <= frames; ++v) {
+            set_frame(tb.back(), v);
+            tb.publish_merged(merge_frame);
+        }
+    });
+    uint64_t sum = 0, count = 0, last = 0, seq = 0, updates = 0;
+    bool ordered = true;
+    while (last < frames) {
+        if (tb.update()) {
+            const frame_acc_t& f = tb.front();
+            ordered = ordered && f.last > last && tb.sequence() > seq;
+            sum += f.sum;
+            count += f.count;
+            last = f.last;
+            seq = tb.sequence();
+            ++updates;
+        }
+    }
+    producer.join();
+
+    REQUIRE(false == tb.update());
+    REQUIRE(true == ordered);
+    REQUIRE(frames == last);
+    REQUIRE(frames == seq);
+    REQUIRE(frames == count);
+    REQUIRE(frames * (frames + 1) / 2 == sum);
+    REQUIRE(updates <= frames);
+}
+
+TEST_CASE("Triple Buffer Test 10 - Input Snapshot Merge", "[triple_buffer][input]") {
+    input_snapshot_t tb;
+    input_event_t event;
+    auto merge = [](input_event_t& newer, const input_event_t& older) noexcept { newer.merge_previous(older); };
+
+    // frame 1: RESET pressed and released, P1_UP pressed
+    event.begin_frame();
+    event.set(input_event_type_t::RESET);
+    event.clear(input_event_type_t::RESET);
+    event.set(input_event_type_t::P1_UP);
+    event.text.append("ab");
+    tb.back() = event;
+    tb.publish_merged(merge);
+
+    // frame 2, frame 1 not acquired: RESET pressed again and held, P1_UP released
+    event.begin_frame();
+    event.set(input_event_type_t::RESET);
+    event.clear(input_event_type_t::P1_UP);
+    event.text.append("cd");
+    tb.back() = event;
+    tb.publish_merged(merge);
+
+    REQUIRE(true == tb.update());
+    input_event_t s = tb.front();
+    REQUIRE(true == s.pressed(input_event_type_t::RESET));
+    REQUIRE(true == s.pressed_in_frame(input_event_type_t::RESET));
+    REQUIRE(false == s.released_and_clr(input_event_type_t::RESET));  // stale release of frame 1 dropped
+    REQUIRE(false == s.pressed(input_event_type_t::P1_UP));
+    REQUIRE(true == s.pressed_in_frame(input_event_type_t::P1_UP));
+    REQUIRE(true == s.released_and_clr(input_event_type_t::P1_UP));
+    REQUIRE("abcd" == s.text.view());
+    REQUIRE(false == tb.update());
+}